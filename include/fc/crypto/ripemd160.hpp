@@ -80,6 +80,11 @@ class ripemd160
 
   template<> struct get_typename<uint160_t>    { static const char* name()  { return "uint160_t";  } };
 
+  namespace raw {
+    /** packed as its memory, see operator<< */
+    template<> struct is_trivially_packed<ripemd160> : std::integral_constant<bool, sizeof(ripemd160) == 20> {};
+  }
+
 } // namespace fc
 
 namespace std
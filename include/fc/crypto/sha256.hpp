@@ -106,6 +106,11 @@ class sha256
 
   uint64_t hash64(const char* buf, size_t len);    
 
+  namespace raw {
+    /** packed as its memory, see operator<< */
+    template<> struct is_trivially_packed<sha256> : std::integral_constant<bool, sizeof(sha256) == 32> {};
+  }
+
 } // fc
 namespace std
 {
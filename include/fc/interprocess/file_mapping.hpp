@@ -36,6 +36,8 @@ namespace fc {
       void  flush();
       void* get_address()const;
       size_t get_size()const;
+      /** tells the kernel the region will be read front to back, returns false where that is not supported */
+      bool  advise_sequential();
     private:
       fc::fwd<boost::interprocess::mapped_region,40> my;
   };
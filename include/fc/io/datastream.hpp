@@ -89,6 +89,64 @@ class datastream<size_t> {
      size_t _size;
 };
 
+/**
+ *  Appends what is written to a container of chars, a std::vector<char>, a std::string or a
+ *  shared_buffer, growing it as needed, so that many values can be packed one after the other
+ *  into one buffer without a test run with datastream<size_t> for each.  The container is
+ *  resized ahead of the writes and cut back to what was written when the stream is destroyed.
+ *  tellp() counts from the size the container had when the stream was made.
+ */
+template<typename Container>
+class growable_datastream {
+   public:
+     growable_datastream( Container& c, size_t reserve = 256 )
+     :_container(c),_start(c.size()),_pos(0),_end(0)
+     {
+        grow( reserve );
+     }
+     ~growable_datastream() { _container.resize( _start + tellp() ); }
+
+     inline bool skip( size_t s ) {
+        if( size_t(_end - _pos) < s )
+           grow( s );
+        _pos += s;
+        return true;
+     }
+     inline bool write( const char* d, size_t s ) {
+        if( size_t(_end - _pos) < s )
+           grow( s );
+        memcpy( _pos, d, s );
+        _pos += s;
+        return true;
+     }
+     inline bool put( char c ) {
+        if( _pos == _end )
+           grow( 1 );
+        *_pos++ = c;
+        return true;
+     }
+
+     inline bool     valid()const     { return true;                            }
+     inline size_t   tellp()const     { return _pos ? _pos - begin() : 0;       }
+     inline size_t   remaining()const { return 0;                               }
+  private:
+     char* begin()const { return &_container[0] + _start; }
+
+     /** makes room for @a s more chars, at least doubling what is written to */
+     void grow( size_t s ) {
+        const size_t written = tellp();
+        const size_t room = written + s > 2 * written ? written + s : 2 * written;
+        _container.resize( _start + ( room ? room : 1 ) );
+        _pos = begin() + written;
+        _end = &_container[0] + _container.size();
+     }
+
+     Container& _container;
+     size_t     _start;
+     char*      _pos;
+     char*      _end;
+};
+
 template<typename ST>
 inline datastream<ST>& operator<<(datastream<ST>& ds, const int32_t& d) {
   ds.write( (const char*)&d, sizeof(d) );
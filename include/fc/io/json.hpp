@@ -1,11 +1,13 @@
 #pragma once
 #include <fc/variant.hpp>
+#include <fc/variant_limits.hpp>
 #include <fc/filesystem.hpp>
 
 namespace fc
 {
    class ostream;
    class buffered_istream;
+   class variant_arena;
 
    /**
     *  Provides interface for json serialization.
@@ -20,7 +22,13 @@ namespace fc
             legacy_parser         = 0,
             strict_parser         = 1,
             relaxed_parser        = 2,
-            legacy_parser_with_string_doubles = 3
+            legacy_parser_with_string_doubles = 3,
+            /**
+             *  Gives the results of legacy_parser, but indexes the quotes and escapes of the whole
+             *  document with SIMD instructions first and builds the tree from that index.  Only
+             *  from_string benefits, streams and files are read by the legacy_parser.
+             */
+            structural_parser     = 4
          };
          enum output_formatting
          {
@@ -36,11 +44,62 @@ namespace fc
          static variant  from_stream( buffered_istream& in, parse_type ptype = legacy_parser );
 
          static variant  from_string( const string& utf8_str, parse_type ptype = legacy_parser );
+         /** like from_string( utf8_str, ptype ) but fails once the tree exceeds one of @a limits */
+         static variant  from_string( const string& utf8_str, const parse_limits& limits, parse_type ptype = legacy_parser );
+         /** like from_string( utf8_str, ptype ) with the strings, arrays and objects of the tree allocated from @a arena */
+         static variant  from_string( const string& utf8_str, variant_arena& arena, parse_type ptype = legacy_parser );
+
+         /**
+          *  Parses straight into T without building a variant tree, the result and the errors are
+          *  the ones of from_string( utf8_str ).as<T>().  The strict and relaxed parsers still go
+          *  through a variant.
+          *  @see json_reader
+          */
+         template<typename T>
+         static T        from_string( const string& utf8_str, parse_type ptype = legacy_parser );
+         template<typename T>
+         static T        from_stream( buffered_istream& in, parse_type ptype = legacy_parser );
+
          static variants variants_from_string( const string& utf8_str, parse_type ptype = legacy_parser );
+
+         /**
+          *  Writes the text of to_stream( out, v, format ).  Arrays and objects of many thousands of
+          *  elements, wherever they are in @a v, are cut into chunks that fc::thread workers write
+          *  into buffers of their own, while the calling thread hands the buffers to @a out in order.
+          *
+          *  @param threads the number of workers to use, one per core if 0
+          */
+         static ostream& to_stream_parallel( ostream& out, const variant& v, output_formatting format = stringify_large_ints_and_doubles, uint32_t threads = 0 );
+         /** the text of to_string( v, format ), written like to_stream_parallel() writes it */
+         static string   to_string_parallel( const variant& v, output_formatting format = stringify_large_ints_and_doubles, uint32_t threads = 0 );
+
+         /**
+          *  Writes @a values as NDJSON, newline delimited JSON: the text of to_string( value, format )
+          *  and a '\n' for each value.  Many values are written in chunks like to_stream_parallel()
+          *  writes them.
+          */
+         static ostream& to_ndjson( ostream& out, const variants& values, output_formatting format = stringify_large_ints_and_doubles, uint32_t threads = 0 );
+         static string   to_ndjson( const variants& values, output_formatting format = stringify_large_ints_and_doubles, uint32_t threads = 0 );
+         /**
+          *  Reads NDJSON, each line that is not blank like from_string( line, ptype ).  Many lines
+          *  are parsed in chunks on up to @a threads fc::thread workers, one per core if 0.
+          *
+          *  @throws the exception of the first line that does not parse, with its line number
+          */
+         static variants variants_from_ndjson( const string& utf8_str, parse_type ptype = legacy_parser, uint32_t threads = 0 );
          static string   to_string( const variant& v, output_formatting format = stringify_large_ints_and_doubles );
          static string   to_pretty_string( const variant& v, output_formatting format = stringify_large_ints_and_doubles );
 
          static bool     is_valid( const std::string& json_str, parse_type ptype = legacy_parser );
+         /**
+          *  Checks @a json_str like is_valid( json_str, ptype ), but returns false rather than throwing
+          *  for malformed documents.  No variant is built and the text of the strings is not copied,
+          *  containers may be nested 16K levels deep.
+          *
+          *  @param error_offset set to the offset of the byte where the parser fails, the start of a
+          *         number that does not convert or the size of @a json_str if it ends too early
+          */
+         static bool     is_valid( const std::string& json_str, size_t& error_offset, parse_type ptype = legacy_parser );
 
          template<typename T>
          static void     save_to_file( const T& v, const fc::path& fi, bool pretty = true, output_formatting format = stringify_large_ints_and_doubles )
@@ -49,6 +108,10 @@ namespace fc
          }
 
          static void     save_to_file( const variant& v, const fc::path& fi, bool pretty = true, output_formatting format = stringify_large_ints_and_doubles );
+         /**
+          *  Maps the file into memory and parses it like from_string() parses the same text, without
+          *  copying it into a string first.
+          */
          static variant  from_file( const fc::path& p, parse_type ptype = legacy_parser );
 
          template<typename T>
@@ -57,17 +120,23 @@ namespace fc
             return json::from_file(p, ptype).as<T>();
          }
 
+         /**
+          *  Writes reflected types straight to JSON, the result is the same as to_string( variant(v) ).
+          *  @see json_writer
+          */
          template<typename T>
-         static string   to_string( const T& v, output_formatting format = stringify_large_ints_and_doubles ) 
-         {
-            return to_string( variant(v), format );
-         }
+         static string   to_string( const T& v, output_formatting format = stringify_large_ints_and_doubles );
+         /**
+          *  Appends the text of to_string( v, format ) to @a out.  A string that is cleared and passed
+          *  again for the next document keeps its capacity, so serializing many documents with one
+          *  string stops allocating once it has grown to the largest of them.
+          */
+         template<typename T>
+         static void     to_string( const T& v, string& out, output_formatting format = stringify_large_ints_and_doubles );
 
+         /** like to_string( v, format ), with the layout of to_pretty_string( variant(v), format ) */
          template<typename T>
-         static string   to_pretty_string( const T& v, output_formatting format = stringify_large_ints_and_doubles ) 
-         {
-            return to_pretty_string( variant(v), format );
-         }
+         static string   to_pretty_string( const T& v, output_formatting format = stringify_large_ints_and_doubles );
 
          template<typename T>
          static void save_to_file( const T& v, const std::string& p, bool pretty = true, output_formatting format = stringify_large_ints_and_doubles ) 
@@ -77,3 +146,6 @@ namespace fc
    };
 
 } // fc
+
+#include <fc/io/json_writer.hpp>
+#include <fc/io/json_reader.hpp>
@@ -0,0 +1,72 @@
+#pragma once
+#include <fc/io/json.hpp>
+#include <vector>
+
+namespace fc
+{
+   /**
+    *  @brief The text of one value within a JSON document, not parsed yet.
+    *
+    *  It points into the document it was found in, which has to outlive it.
+    */
+   struct json_slice
+   {
+      const char* data = nullptr;
+      size_t      size = 0;
+
+      /** false if the document has no value at the path */
+      bool     found()const { return data != nullptr; }
+      string   str()const   { return string( data, size ); }
+      /** the value, like json::from_string( str(), ptype ) reads it, or null if it was not found */
+      variant  parse( json::parse_type ptype = json::legacy_parser )const;
+   };
+
+   /**
+    *  @brief Finds the values at a few paths of a JSON document without parsing the rest of it.
+    *
+    *  A path lists the keys of the objects and the indexes of the arrays on the way from the root
+    *  to a value, the indexes in decimal.  The document is read once for all paths.  Objects and
+    *  arrays that are on the way to a path are walked, any other value is only skipped over,
+    *  looking at its quotes and brackets but not at what they contain.  As in a parsed document,
+    *  the first of duplicate keys counts, and repeated commas are skipped like the legacy parser does.
+    *
+    *  @code
+    *     static const fc::json_extractor routing( { { "id" }, { "method" }, { "params", "0" } } );
+    *     const std::vector<fc::json_slice> fields = routing.slices( message.data(), message.size() );
+    *     if( fields[1].found() && fields[1].parse().as_string() == "call" )
+    *        forward( fields[2].parse(), message );
+    *  @endcode
+    */
+   class json_extractor
+   {
+      public:
+         typedef std::vector<string> path;
+
+         /** at most 64 @a paths */
+         explicit json_extractor( std::vector<path> paths );
+
+         /**
+          *  @return the text of the value at each path, in the order of the paths
+          *  @throws parse_error_exception if the parts of the document that are read are malformed
+          */
+         std::vector<json_slice> slices( const char* data, size_t size )const;
+
+         /** the values of slices( json ), null where a path has no value */
+         variants values( const string& json, json::parse_type ptype = json::legacy_parser )const;
+
+         size_t size()const { return _paths.size(); }
+
+      private:
+         struct step
+         {
+            string   key;
+            /** key as an array index, or UINT32_MAX if it is none */
+            uint32_t index;
+         };
+
+         friend class json_scanner;
+
+         std::vector< std::vector<step> > _paths;
+   };
+
+} // fc
@@ -0,0 +1,24 @@
+#pragma once
+
+// This file is an internal header,
+// it is not meant to be included except internally from the json parsers in fc
+
+#include <fc/string.hpp>
+
+namespace fc { namespace json_number
+{
+   /**
+    *  The same as to_uint64(), to_int64() and to_double() of string( begin, end ), to the bit and
+    *  with the same exceptions, but without the string and the lexical_cast for the forms numbers
+    *  usually have.  Integers of up to 19 digits, with a minus sign for to_int64(), are read
+    *  directly.  Doubles of up to 19 significant digits, with a fraction and an exponent, are read
+    *  directly when the digits and the power of ten are both exact doubles, so one rounded
+    *  multiplication or division gives the correctly rounded result (Clinger's fast path), which
+    *  is what lexical_cast returns too.  Other integers are given to lexical_cast as they are,
+    *  other doubles go to fc::to_double(), which allocates.
+    */
+   uint64_t to_uint64( const char* begin, const char* end );
+   int64_t  to_int64( const char* begin, const char* end );
+   double   to_double( const char* begin, const char* end );
+
+} } // fc::json_number
@@ -0,0 +1,52 @@
+#pragma once
+#include <fc/io/json.hpp>
+#include <memory>
+
+namespace fc
+{
+   class istream;
+
+   namespace detail { class json_push_parser_impl; }
+
+   /**
+    *  @brief Parses a stream of JSON values from chunks of bytes as they arrive.
+    *
+    *  feed() takes any piece of the input and returns the top level values it completed.  Whatever
+    *  is still incomplete, a string, a number or a nested container, is kept across calls, so a
+    *  large message is parsed while it is received and its text is never assembled in one string.
+    *  The values and the errors are those of json::from_stream() called once per value.
+    *
+    *  A number or a word at the top level is only complete once the character after it arrives,
+    *  finish() completes it at the end of the input.  After an exception the parser has to be
+    *  reset() before it is fed again.
+    *
+    *  @code
+    *     fc::json_push_parser parser;
+    *     while( true )
+    *        for( const fc::variant& message : parser.feed( *socket ) )
+    *           handle( message );
+    *  @endcode
+    */
+   class json_push_parser
+   {
+      public:
+         /** @a ptype is one of the legacy parsers, @a limits apply to each top level value */
+         explicit json_push_parser( json::parse_type ptype = json::legacy_parser, const parse_limits& limits = parse_limits() );
+         ~json_push_parser();
+
+         variants feed( const char* data, size_t size );
+         /** feeds what one readsome() of @a in returns, it waits for at least one byte */
+         variants feed( istream& in );
+
+         /** completes a number or word left at the top level, throws if a value is incomplete */
+         variants finish();
+
+         /** true between top level values */
+         bool     idle()const;
+         void     reset();
+
+      private:
+         std::unique_ptr<detail::json_push_parser_impl> my;
+   };
+
+} // fc
@@ -0,0 +1,393 @@
+#pragma once
+#include <fc/io/json.hpp>
+#include <fc/io/sstream.hpp>
+#include <fc/exception/exception.hpp>
+#include <bitset>
+#include <type_traits>
+#include <utility>
+
+namespace fc
+{
+   // provided by json.cpp for fc::stringstream and fc::buffered_istream
+   template<typename T, json::parse_type parser_type> variant variant_from_stream( T& in );
+   template<typename T> fc::string stringFromStream( T& in );
+   template<typename T> bool skip_white_space( T& in );
+   void check_string_depth( const string& utf8_str );
+
+   namespace detail
+   {
+      namespace from_variant_probe
+      {
+         struct result {};
+
+         /**
+          *  Never defined, they only take part in overload resolution.  Each has the signature of
+          *  one of the generic from_variant() overloads of fc that json_reader reads in place of.
+          */
+         template<typename T> result from_variant( const fc::variant& v, T& o );
+         template<typename... T> result from_variant( const fc::variant& v, static_variant<T...>& o );
+         template<typename T> result from_variant( const fc::variant& v, optional<T>& o );
+         template<typename T> result from_variant( const fc::variant& v, std::vector<T>& o );
+         template<typename T> result from_variant( const fc::variant& v, std::deque<T>& o );
+         template<typename T> result from_variant( const fc::variant& v, std::set<T>& o );
+         template<typename T> result from_variant( const fc::variant& v, std::unordered_set<T>& o );
+         template<typename T> result from_variant( const fc::variant& v, flat_set<T>& o );
+         template<typename K, typename T> result from_variant( const fc::variant& v, std::map<K,T>& o );
+         template<typename T> result from_variant( const fc::variant& v, std::map<string,T>& o );
+         template<typename K, typename T> result from_variant( const fc::variant& v, std::multimap<K,T>& o );
+         template<typename K, typename T> result from_variant( const fc::variant& v, std::unordered_map<K,T>& o );
+         template<typename K, typename... T> result from_variant( const fc::variant& v, flat_map<K,T...>& o );
+         template<typename K, typename T, typename... A> result from_variant( const fc::variant& v, flat_map<K,T,A...>& o );
+         template<typename A, typename B> result from_variant( const fc::variant& v, std::pair<A,B>& o );
+
+         template<typename T, typename = void>
+         struct is_ambiguous : std::true_type {};
+
+         template<typename T>
+         struct is_ambiguous<T, decltype( void( from_variant( std::declval<const fc::variant&>(), std::declval<T&>() ) ) )>
+         : std::false_type {};
+      }
+
+      /**
+       *  True when T is converted by one of the generic from_variant() overloads of fc, see
+       *  uses_generic_to_variant for how other overloads are told apart.
+       */
+      template<typename T>
+      struct uses_generic_from_variant : from_variant_probe::is_ambiguous<T> {};
+   }
+
+   /**
+    *  Parses JSON straight into reflected types without building a variant tree.
+    *
+    *  The grammar is the one of the legacy parser and values end up exactly as from_variant()
+    *  would leave them: objects and arrays are read into reflected structs, containers, pairs,
+    *  optionals and static_variants while they are parsed, scalars and types with their own
+    *  from_variant() are parsed to a variant and converted by it.
+    *
+    *  @tparam Stream fc::stringstream or fc::buffered_istream
+    */
+   template<typename Stream, json::parse_type parser_type>
+   class json_reader
+   {
+      public:
+         json_reader( Stream& in ):_in(in){}
+
+         /**
+          *  Reads T in place when a generic from_variant() of fc would convert it, and parses a
+          *  variant for the from_variant() of its own when T has one.
+          */
+         template<typename T>
+         void read( T& v )
+         {
+            read_value( v, std::integral_constant<bool, detail::uses_generic_from_variant<T>::value>() );
+         }
+
+         void read( string& v )
+         {
+            if( next_is( '"' ) )
+               v = stringFromStream( _in );
+            else
+               read_leaf( v );
+         }
+
+         void read( std::vector<char>& v ) { read_leaf( v ); }
+
+      private:
+         /**
+          *  Reads the value of @a key into the member of that name.  The first of duplicate keys
+          *  wins like it does for variant_object::find(), later ones are skipped.
+          */
+         template<typename T, typename Members>
+         class member_reader
+         {
+            public:
+               member_reader( json_reader& r, T& v, const string& k, Members& m, bool& f )
+               :reader(r),val(v),key(k),done(m),found(f){}
+
+               template<typename Member, class Class, Member (Class::*member)>
+               void operator()( const char* name )const
+               {
+                  const size_t index = next_index++;
+                  if( found || key != name )
+                     return;
+                  found = true;
+                  if( done[index] )
+                     reader.skip_value();
+                  else
+                  {
+                     done[index] = true;
+                     reader.read( val.*member );
+                  }
+               }
+
+            private:
+               json_reader&     reader;
+               T&               val;
+               const string&    key;
+               Members&         done;
+               bool&            found;
+               mutable size_t   next_index = 0;
+         };
+
+         struct static_variant_reader
+         {
+            typedef void result_type;
+            static_variant_reader( json_reader& r ):reader(r){}
+
+            template<typename T>
+            void operator()( T& v )const { reader.read( v ); }
+
+            json_reader& reader;
+         };
+
+         template<typename T>
+         void read_value( T& v, std::false_type ) { read_leaf( v ); }
+
+         template<typename T>
+         void read_value( T& v, std::true_type ) { walk( v ); }
+
+         template<typename T>
+         void walk( T& v )
+         {
+            read_reflected( v, std::integral_constant<bool, fc::reflector<T>::is_defined::value &&
+                                                            !fc::reflector<T>::is_enum::value>() );
+         }
+
+         template<typename T>
+         void walk( optional<T>& v )
+         {
+            if( next_is( '{' ) || next_is( '[' ) )
+            {
+               v = T();
+               read( *v );
+            }
+            else
+               read_leaf( v );
+         }
+
+         template<typename A, typename B>
+         void walk( std::pair<A,B>& v )
+         {
+            if( !next_is( '[' ) )
+               return read_leaf( v );
+            read_array( [&]( size_t index )
+            {
+               if( index == 0 )      read( v.first );
+               else if( index == 1 ) read( v.second );
+               else                  skip_value();
+            });
+         }
+
+         template<typename... T>
+         void walk( static_variant<T...>& v )
+         {
+            if( !next_is( '[' ) )
+               return read_leaf( v );
+            variant which;
+            read_array( [&]( size_t index )
+            {
+               if( index == 0 )
+                  which = variant_from_stream<Stream, parser_type>( _in );
+               else if( index == 1 )
+               {
+                  v.set_which( which.as_uint64() );
+                  v.visit( static_variant_reader( *this ) );
+               }
+               else
+                  skip_value();
+            });
+         }
+
+         template<typename T>
+         void walk( std::vector<T>& v )
+         {
+            if( !next_is( '[' ) )
+               return read_leaf( v );
+            v.clear();
+            read_array( [&]( size_t ) { v.push_back( read_new<T>() ); } );
+         }
+
+         template<typename T>
+         void walk( std::deque<T>& v )
+         {
+            if( !next_is( '[' ) )
+               return read_leaf( v );
+            v.clear();
+            read_array( [&]( size_t ) { v.push_back( read_new<T>() ); } );
+         }
+
+         template<typename T>
+         void walk( std::set<T>& v )           { read_set<T>( v ); }
+         template<typename T>
+         void walk( std::unordered_set<T>& v ) { read_set<T>( v ); }
+         template<typename T>
+         void walk( flat_set<T>& v )           { read_set<T>( v ); }
+
+         template<typename K, typename T>
+         void walk( std::map<K,T>& v )           { read_set< std::pair<K,T> >( v ); }
+         template<typename K, typename T>
+         void walk( std::multimap<K,T>& v )      { read_set< std::pair<K,T> >( v ); }
+         template<typename K, typename T>
+         void walk( std::unordered_map<K,T>& v ) { read_set< std::pair<K,T> >( v ); }
+         template<typename K, typename T, typename... A>
+         void walk( flat_map<K,T,A...>& v )      { read_set< std::pair<K,T> >( v ); }
+
+         template<typename T>
+         void walk( std::map<string,T>& v )
+         {
+            if( !next_is( '{' ) )
+               return read_leaf( v );
+            v.clear();
+            read_object( [&]( const string& key ) { v[key] = read_new<T>(); } );
+         }
+
+         /** types without reflection that only the generic from_variant() matches, like integers, and enums */
+         template<typename T>
+         void read_reflected( T& v, std::false_type ) { read_leaf( v ); }
+
+         template<typename T>
+         void read_reflected( T& v, std::true_type )
+         {
+            if( !next_is( '{' ) )
+               return read_leaf( v );
+            typedef std::bitset<fc::reflector<T>::total_member_count> members;
+            members done;
+            read_object( [&]( const string& key )
+            {
+               bool found = false;
+               fc::reflector<T>::visit( member_reader<T, members>( *this, v, key, done, found ) );
+               if( !found )
+                  skip_value();
+            });
+         }
+
+         /** values that are not read in place are parsed to a variant and converted by from_variant() */
+         template<typename T>
+         void read_leaf( T& v )
+         {
+            variant var = variant_from_stream<Stream, parser_type>( _in );
+            from_variant( var, v );
+         }
+
+         template<typename T>
+         T read_new()
+         {
+            T tmp;
+            read( tmp );
+            return tmp;
+         }
+
+         template<typename T, typename Set>
+         void read_set( Set& v )
+         {
+            if( !next_is( '[' ) )
+               return read_leaf( v );
+            v.clear();
+            read_array( [&]( size_t ) { v.insert( read_new<T>() ); } );
+         }
+
+         void skip_value() { variant_from_stream<Stream, parser_type>( _in ); }
+
+         bool next_is( char c )
+         {
+            skip_white_space( _in );
+            return _in.peek() == c;
+         }
+
+         /** follows arrayFromStream(), @a element is called with the index of every value */
+         template<typename Element>
+         void read_array( Element&& element )
+         {
+            try
+            {
+               _in.get();
+               skip_white_space( _in );
+               size_t index = 0;
+               while( _in.peek() != ']' )
+               {
+                  if( _in.peek() == ',' )
+                  {
+                     _in.get();
+                     continue;
+                  }
+                  if( skip_white_space( _in ) ) continue;
+                  element( index++ );
+                  skip_white_space( _in );
+               }
+               _in.get();
+            } FC_RETHROW_EXCEPTIONS( warn, "Attempting to parse array" );
+         }
+
+         /** follows objectFromStream(), @a member is called with every key before its value */
+         template<typename Member>
+         void read_object( Member&& member )
+         {
+            try
+            {
+               _in.get();
+               skip_white_space( _in );
+               while( _in.peek() != '}' )
+               {
+                  if( _in.peek() == ',' )
+                  {
+                     _in.get();
+                     continue;
+                  }
+                  if( skip_white_space( _in ) ) continue;
+                  string key = stringFromStream( _in );
+                  skip_white_space( _in );
+                  if( _in.peek() != ':' )
+                  {
+                     FC_THROW_EXCEPTION( parse_error_exception, "Expected ':' after key \"${key}\"",
+                                              ("key", key) );
+                  }
+                  _in.get();
+                  member( key );
+                  skip_white_space( _in );
+               }
+               _in.get();
+            }
+            catch( const fc::eof_exception& e )
+            {
+               FC_THROW_EXCEPTION( parse_error_exception, "Unexpected EOF: ${e}", ("e", e.to_detail_string() ) );
+            }
+            catch( const std::ios_base::failure& e )
+            {
+               FC_THROW_EXCEPTION( parse_error_exception, "Unexpected EOF: ${e}", ("e", e.what() ) );
+            } FC_RETHROW_EXCEPTIONS( warn, "Error parsing object" );
+         }
+
+         Stream& _in;
+   };
+
+   template<typename T>
+   T json::from_string( const string& utf8_str, parse_type ptype )
+   { try {
+      if( ptype != legacy_parser && ptype != legacy_parser_with_string_doubles )
+         return from_string( utf8_str, ptype ).as<T>();
+
+      check_string_depth( utf8_str );
+      fc::stringstream in( utf8_str );
+      T result;
+      if( ptype == legacy_parser )
+         json_reader<fc::stringstream, legacy_parser>( in ).read( result );
+      else
+         json_reader<fc::stringstream, legacy_parser_with_string_doubles>( in ).read( result );
+      return result;
+   } FC_RETHROW_EXCEPTIONS( warn, "", ("str",utf8_str) ) }
+
+   template<typename T>
+   T json::from_stream( buffered_istream& in, parse_type ptype )
+   {
+      if( ptype != legacy_parser && ptype != legacy_parser_with_string_doubles )
+         return from_stream( in, ptype ).as<T>();
+
+      T result;
+      if( ptype == legacy_parser )
+         json_reader<buffered_istream, legacy_parser>( in ).read( result );
+      else
+         json_reader<buffered_istream, legacy_parser_with_string_doubles>( in ).read( result );
+      return result;
+   }
+
+} // fc
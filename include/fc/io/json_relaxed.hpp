@@ -4,6 +4,7 @@
 // it is not meant to be included except internally from json.cpp in fc
 
 #include <fc/io/json.hpp>
+#include <fc/io/json_number.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/io/iostream.hpp>
 #include <fc/io/buffered_iostream.hpp>
@@ -442,7 +443,7 @@ namespace fc { namespace json_relaxed
                        {
                            if( strict )
                                FC_THROW_EXCEPTION( parse_error_exception, "number cannot end with '.' in strict mode" );
-                           return fc::variant( fc::to_double(token.c_str()) );
+                           return fc::variant( fc::json_number::to_double(token.data(), token.data() + token.size()) );
                        }
 
                        //idump((i));
@@ -542,7 +543,7 @@ namespace fc { namespace json_relaxed
                                return fc::variant( token );
                        }
                    }
-                   return fc::variant( fc::to_double(token.c_str()) );
+                   return fc::variant( fc::json_number::to_double(token.data(), token.data() + token.size()) );
                case 'a': case 'b': case 'c': case 'd':           case 'f': case 'g': case 'h':
                case 'i': case 'j': case 'k': case 'l': case 'm': case 'n': case 'o': case 'p':
                case 'q': case 'r': case 's': case 't': case 'u': case 'v': case 'w': case 'x':
@@ -685,8 +686,18 @@ namespace fc { namespace json_relaxed
        FC_THROW_EXCEPTION( parse_error_exception, "expected: null|true|false" );
    }
    
+   template<typename T, bool strict>
+   variant value_from_stream( T& in );
+
+   /** parses one value and charges it to the parse_budget of the thread, if any */
    template<typename T, bool strict>
    variant variant_from_stream( T& in )
+   {
+      return budgeted_parse( [&]() { return json_relaxed::value_from_stream<T, strict>( in ); } );
+   }
+
+   template<typename T, bool strict>
+   variant value_from_stream( T& in )
    {
       skip_white_space(in);
       variant var;
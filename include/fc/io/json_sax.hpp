@@ -0,0 +1,158 @@
+#pragma once
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+#include <functional>
+#include <memory>
+
+namespace fc
+{
+   class istream;
+
+   namespace detail { class json_sax_parser_impl; }
+
+   /**
+    *  @brief Receives a JSON document as a sequence of events instead of a variant tree.
+    *
+    *  Every value is reported once it is complete, containers by a start and an end event around
+    *  their contents and every member of an object by on_key() before its value.  Strings are
+    *  passed as rvalues the handler may take over.
+    */
+   class json_sax_handler
+   {
+      public:
+         virtual ~json_sax_handler(){}
+
+         virtual void on_null() = 0;
+         virtual void on_bool( bool b ) = 0;
+         virtual void on_int64( int64_t i ) = 0;
+         virtual void on_uint64( uint64_t i ) = 0;
+         virtual void on_double( double d ) = 0;
+         virtual void on_string( string&& s ) = 0;
+         virtual void on_start_object() = 0;
+         virtual void on_key( string&& key ) = 0;
+         virtual void on_end_object() = 0;
+         virtual void on_start_array() = 0;
+         virtual void on_end_array() = 0;
+   };
+
+   /**
+    *  @brief Tokenizes JSON for a json_sax_handler, from chunks of bytes as they arrive.
+    *
+    *  This is the legacy parser turned inside out, it reads the same documents and raises the
+    *  same errors, including its lenient commas and unquoted words.  Only the string being read
+    *  and a flag per open container are kept, so memory does not grow with the document.  A number
+    *  or a word at the top level is only complete once the character after it arrives, finish()
+    *  completes it at the end of the input.  After an exception the parser has to be reset().
+    *
+    *  A string that grows past the max_bytes of the parse_budget of the thread, if there is one,
+    *  is rejected before it is complete.
+    */
+   class json_sax_parser
+   {
+      public:
+         /**
+          *  @a ptype is one of the legacy parsers.  With @a check_only the text of strings, keys and
+          *  unquoted words is checked but not kept, the handler gets them empty and nothing is
+          *  allocated for them.
+          */
+         explicit json_sax_parser( json_sax_handler& handler, json::parse_type ptype = json::legacy_parser,
+                                   bool check_only = false );
+         ~json_sax_parser();
+
+         void     feed( const char* data, size_t size );
+         /**
+          *  Feeds @a data up to the end of the next top level value, a number or a word at the top level
+          *  still needs the character after it.  @return the number of bytes read
+          */
+         size_t   feed_value( const char* data, size_t size );
+         /** feeds what one readsome() of @a in returns, it waits for at least one byte */
+         void     feed( istream& in );
+         /** completes a number or word left at the top level, throws if a value is incomplete */
+         void     finish();
+
+         /** true between top level values */
+         bool     idle()const;
+         /** the number of open containers */
+         uint32_t depth()const;
+         /**
+          *  The number of bytes read so far, after an exception the offset of the byte it was raised at
+          *  or of the start of a number that does not convert.
+          */
+         size_t   offset()const;
+         void     reset();
+
+         /** parses all values of @a data */
+         static void parse( const char* data, size_t size, json_sax_handler& handler, json::parse_type ptype = json::legacy_parser );
+         /** parses all values until the end of @a in */
+         static void parse( istream& in, json_sax_handler& handler, json::parse_type ptype = json::legacy_parser );
+
+      private:
+         std::unique_ptr<detail::json_sax_parser_impl> my;
+   };
+
+   /**
+    *  @brief Builds a variant for every value found at a given depth of a document.
+    *
+    *  Events outside of those values are skipped, so a document of any size can be walked one
+    *  subtree at a time, the root being at depth 0 like it is for walk_variant():
+    *
+    *  @code
+    *     // every block of a multi-GB array of blocks, one at a time
+    *     fc::json_subtree_reader::read( in, 1, [&]( fc::variant&& block ) { index( block ); } );
+    *  @endcode
+    *
+    *  The values are charged to the parse_budget of the thread like the legacy parser charges them,
+    *  each value on its own.
+    */
+   class json_subtree_reader : public json_sax_handler
+   {
+      public:
+         typedef std::function<void( variant&& )> callback;
+
+         json_subtree_reader( uint32_t depth, callback on_value );
+
+         /** parses @a data and calls @a on_value with every value at @a depth, each within @a limits */
+         static void read( const char* data, size_t size, uint32_t depth, const callback& on_value,
+                           const parse_limits& limits = parse_limits(), json::parse_type ptype = json::legacy_parser );
+         /** the same for all values until the end of @a in */
+         static void read( istream& in, uint32_t depth, const callback& on_value,
+                           const parse_limits& limits = parse_limits(), json::parse_type ptype = json::legacy_parser );
+
+         /** forgets a subtree left incomplete by an error */
+         void reset();
+
+         virtual void on_null() override                  { if( begin_value() ) complete( variant() ); }
+         virtual void on_bool( bool b ) override          { if( begin_value() ) complete( variant( b ) ); }
+         virtual void on_int64( int64_t i ) override      { if( begin_value() ) complete( variant( i ) ); }
+         virtual void on_uint64( uint64_t i ) override    { if( begin_value() ) complete( variant( i ) ); }
+         virtual void on_double( double d ) override      { if( begin_value() ) complete( variant( d ) ); }
+         virtual void on_string( string&& s ) override    { if( begin_value() ) complete( variant( std::move( s ) ) ); }
+         virtual void on_start_object() override;
+         virtual void on_key( string&& key ) override;
+         virtual void on_end_object() override;
+         virtual void on_start_array() override;
+         virtual void on_end_array() override;
+
+      private:
+         struct frame
+         {
+            explicit frame( bool o ):object(o){}
+
+            bool                    object;
+            variants                elements;
+            mutable_variant_object  members;
+            string                  key;
+         };
+
+         /** @return true if the value starting now is part of a subtree, checks its depth */
+         bool begin_value();
+         /** hands a finished value to its container, or to the callback at the root of a subtree */
+         void complete( variant&& v );
+
+         const uint32_t       _depth;
+         callback             _on_value;
+         uint32_t             _open = 0;
+         std::vector<frame>   _frames;
+   };
+
+} // fc
@@ -0,0 +1,50 @@
+#pragma once
+
+// This file is an internal header,
+// it is not meant to be included except internally from json.cpp in fc
+
+#include <fc/variant.hpp>
+#include <vector>
+
+namespace fc { namespace json_structural
+{
+   /**
+    *  Positions of the quotes and backslashes of a document that are not escaped by a backslash,
+    *  found 64 bytes at a time with AVX2 or SSE2 when the CPU has them.
+    */
+   struct structural_index
+   {
+      std::vector<uint32_t> positions;
+      /** set when the document has a NUL or ^D byte, which the legacy parser treats as its end */
+      bool                  has_terminator = false;
+   };
+
+   void build_index( const char* data, size_t size, structural_index& index );
+
+   /** find_escape() past the first characters, with AVX2 or SSE2 when the CPU has them */
+   const char* find_escape_in_blocks( const char* begin, const char* end );
+
+   /**
+    *  @return the first character of [@a begin, @a end) that a JSON string has to escape, a quote,
+    *  a backslash or a control character, or @a end.  Escapes come in clusters, so the next few
+    *  characters are looked at one by one before 32 or 16 bytes at a time.
+    */
+   inline const char* find_escape( const char* begin, const char* end )
+   {
+      for( const char* stop = begin + ( end - begin < 16 ? end - begin : 16 ); begin != stop; ++begin )
+         if( (unsigned char)*begin < 0x20 || *begin == '"' || *begin == '\\' )
+            return begin;
+      return begin == end ? end : find_escape_in_blocks( begin, end );
+   }
+
+   /**
+    *  Parses the first value of the @a size bytes at @a data like json::legacy_parser does, but
+    *  from a structural index instead of a character stream.
+    *
+    *  @return false, with nothing charged to the parse_budget, for documents where the result could
+    *          differ from the legacy parser: errors, unquoted words, numbers with letters and other
+    *          lenient forms.  The caller parses those with the legacy parser instead.
+    */
+   bool parse( const char* data, size_t size, variant& result );
+
+} } // fc::json_structural
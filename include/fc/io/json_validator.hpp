@@ -0,0 +1,25 @@
+#pragma once
+
+// This file is an internal header,
+// it is not meant to be included except internally from json.cpp in fc
+
+#include <fc/io/json.hpp>
+
+namespace fc { namespace json_validator
+{
+   /**
+    *  Checks that the @a size bytes at @a data are one value that the strict parser, or the relaxed
+    *  one unless @a strict, reads up to the last byte, with the same quirks, but without building it.
+    *  Nothing is allocated, except to decode a word longer than 256 bytes that has escapes in it.
+    *  Containers may be nested max_depth levels deep.  The legacy parsers are checked by a
+    *  json_sax_parser instead.
+    *
+    *  @return false with @a error_offset set to the offset of the byte where the parser fails,
+    *          the start of a number it can not convert or @a size if the document ends too early
+    */
+   bool validate_relaxed( const char* data, size_t size, bool strict, size_t& error_offset );
+
+   /** how deep is_valid() lets containers be nested, for every parser */
+   const uint32_t max_depth = 16 * 1024;
+
+} } // fc::json_validator
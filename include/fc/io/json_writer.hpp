@@ -0,0 +1,393 @@
+#pragma once
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+
+namespace fc
+{
+   template<typename T> struct safe;
+
+   /**
+    *  @brief The growable buffer JSON text is written to.
+    *
+    *  The text is appended to a std::string, a buffer that is cleared and reused for many documents
+    *  keeps its capacity and stops allocating once it fits the largest of them.  A buffer made for
+    *  an ostream collects the text in a string of its own and hands it over in pieces of about
+    *  flush_size bytes, the last piece when flush() is called.
+    *
+    *  With an @a indent the text is pretty printed as it is written, in the layout json::to_pretty_string()
+    *  has always had: every member and element on a line of its own, except containers that follow
+    *  an opening bracket or a comma directly.
+    */
+   class json_buffer
+   {
+      public:
+         enum { flush_size = 64 * 1024 };
+
+         explicit json_buffer( string& out, uint8_t indent = 0 ):_text(out),_stream(nullptr),_indent(indent){}
+         explicit json_buffer( ostream& out, uint8_t indent = 0 ):_text(_own),_stream(&out),_indent(indent){}
+
+         /** '[' or '{' */
+         void open( char c )
+         {
+            _text.push_back( c );
+            ++_level;
+            _pending_line = _indent != 0;
+         }
+         /** ']' or '}', on a line of its own unless the container is empty */
+         void close( char c )
+         {
+            --_level;
+            if( _pending_line )
+               _pending_line = false;
+            else if( _indent )
+               new_line();
+            _text.push_back( c );
+         }
+         /** the ',' between members and elements */
+         void separator()
+         {
+            _text.push_back( ',' );
+            _pending_line = _indent != 0;
+         }
+         /** the ':' between a key and its value */
+         void key_separator()
+         {
+            if( _indent )
+               _text.append( ": ", 2 );
+            else
+               _text.push_back( ':' );
+         }
+
+         void write_null()                          { begin_value(); _text.append( "null", 4 ); }
+         void write_bool( bool b )                  { begin_value(); _text.append( b ? "true" : "false", b ? 4 : 5 ); }
+         /** the text of operator<< of the integers and of fc::to_string( double ), within quotes if @a quoted */
+         void write_int( int64_t i, bool quoted = false );
+         void write_uint( uint64_t i, bool quoted = false );
+         void write_double( double d, bool quoted = false );
+         /** @a str quoted and escaped */
+         void write_string( const char* str, size_t len );
+         /** @a len bytes that are JSON text already, like what another buffer wrote */
+         void append( const char* text, size_t len ) { begin_value(); _text.append( text, len ); }
+
+         /** called between values, hands the text over to the ostream once there is enough of it */
+         void maybe_flush()
+         {
+            if( _stream && _text.size() >= flush_size )
+               flush();
+         }
+         void flush();
+
+      private:
+         void begin_value()
+         {
+            if( _pending_line )
+            {
+               _pending_line = false;
+               new_line();
+            }
+         }
+         void new_line()
+         {
+            _text.push_back( '\n' );
+            _text.append( size_t(_level) * _indent, ' ' );
+         }
+         void write_digits( uint64_t i );
+
+         string    _own;
+         string&   _text;
+         ostream*  _stream;
+         uint8_t   _indent;
+         uint32_t  _level = 0;
+         bool      _pending_line = false;
+   };
+
+   namespace detail
+   {
+      namespace to_variant_probe
+      {
+         struct result {};
+
+         /**
+          *  Never defined, they only take part in overload resolution.  Each has the signature of
+          *  one of the generic to_variant() overloads of fc that json_writer walks instead.
+          */
+         template<typename T> result to_variant( const T& o, fc::variant& v );
+         template<typename... T> result to_variant( const static_variant<T...>& o, fc::variant& v );
+         template<typename T> result to_variant( const std::vector<T>& o, fc::variant& v );
+         template<typename T> result to_variant( const std::deque<T>& o, fc::variant& v );
+         template<typename T> result to_variant( const std::set<T>& o, fc::variant& v );
+         template<typename T> result to_variant( const std::unordered_set<T>& o, fc::variant& v );
+         template<typename T> result to_variant( const flat_set<T>& o, fc::variant& v );
+         template<typename K, typename T> result to_variant( const std::map<K,T>& o, fc::variant& v );
+         template<typename T> result to_variant( const std::map<string,T>& o, fc::variant& v );
+         template<typename K, typename T> result to_variant( const std::multimap<K,T>& o, fc::variant& v );
+         template<typename K, typename T> result to_variant( const std::unordered_map<K,T>& o, fc::variant& v );
+         template<typename K, typename... T> result to_variant( const flat_map<K,T...>& o, fc::variant& v );
+         template<typename A, typename B> result to_variant( const std::pair<A,B>& o, fc::variant& v );
+         template<typename T> result to_variant( const std::shared_ptr<T>& o, fc::variant& v );
+         template<typename T> result to_variant( const std::unique_ptr<T>& o, fc::variant& v );
+         template<typename T> result to_variant( const safe<T>& o, fc::variant& v );
+
+         template<typename T, typename = void>
+         struct is_ambiguous : std::true_type {};
+
+         template<typename T>
+         struct is_ambiguous<T, decltype( void( to_variant( std::declval<const T&>(), std::declval<fc::variant&>() ) ) )>
+         : std::false_type {};
+      }
+
+      /**
+       *  True when variant(T) is built by one of the generic to_variant() overloads of fc, the one
+       *  of reflected types or the ones of containers, pairs, static_variants and smart pointers.
+       *  The probe of the same signature above is then ambiguous with it, while any other overload
+       *  of to_variant() for T, like the ones that print an asset as a string or a static_variant
+       *  of operations as ["name",{...}], is more specialized and wins.
+       */
+      template<typename T>
+      struct uses_generic_to_variant : to_variant_probe::is_ambiguous<T> {};
+   }
+
+   /**
+    *  Writes values as JSON without converting them to a variant first.
+    *
+    *  The output is identical to json::to_string( variant(v), format ).  Reflected structs and
+    *  enums, strings, containers, pairs, optionals, static_variants and smart pointers are walked
+    *  directly unless they have a to_variant() of their own.  Those and every other type are
+    *  converted with their to_variant() and written from that.
+    */
+   class json_writer
+   {
+      public:
+         json_writer( json_buffer& out, json::output_formatting format = json::stringify_large_ints_and_doubles )
+         :_out(out),_format(format){}
+
+         void write( const variant& v );
+         void write( const variant_object& v );
+         void write( const variants& v );
+         void write( const string& v )               { _out.write_string( v.data(), v.size() ); }
+         void write( const std::vector<char>& v )    { write( variant( v ) ); }
+
+         /**
+          *  Walks T when variant(T) would be built by a generic to_variant() of fc, and writes
+          *  variant(v) when T has a to_variant() of its own.
+          */
+         template<typename T>
+         void write( const T& v )
+         {
+            write_value( v, std::integral_constant<bool, detail::uses_generic_to_variant<T>::value>() );
+         }
+
+      private:
+         template<typename T>
+         class member_writer
+         {
+            public:
+               member_writer( json_writer& w, const T& v )
+               :writer(w),val(v){}
+
+               template<typename Member, class Class, Member (Class::*member)>
+               void operator()( const char* name )const
+               {
+                  this->add( name, (val.*member) );
+               }
+
+            private:
+               /** unset optional members are left out just like to_variant() does */
+               template<typename M>
+               void add( const char* name, const optional<M>& v )const
+               {
+                  if( v.valid() )
+                     add_member( name, *v );
+               }
+               template<typename M>
+               void add( const char* name, const M& v )const
+               { add_member( name, v ); }
+
+               template<typename M>
+               void add_member( const char* name, const M& v )const
+               {
+                  if( !first )
+                     writer._out.separator();
+                  first = false;
+                  writer._out.write_string( name, strlen( name ) );
+                  writer._out.key_separator();
+                  writer.write( v );
+               }
+
+               json_writer&   writer;
+               const T&       val;
+               mutable bool   first = true;
+         };
+
+         struct static_variant_writer
+         {
+            typedef void result_type;
+            static_variant_writer( json_writer& w ):writer(w){}
+
+            template<typename T>
+            void operator()( const T& v )const { writer.write( v ); }
+
+            json_writer& writer;
+         };
+
+         template<typename T>
+         void write_value( const T& v, std::false_type ) { write( variant( v ) ); }
+
+         template<typename T>
+         void write_value( const T& v, std::true_type ) { walk( v ); }
+
+         template<typename T>
+         void walk( const T& v )
+         {
+            walk_reflected( v, std::integral_constant<bool, fc::reflector<T>::is_defined::value>() );
+         }
+
+         template<typename T>
+         void walk( const optional<T>& v )
+         {
+            if( v.valid() ) write( *v );
+            else _out.write_null();
+         }
+
+         template<typename T>
+         void walk( const std::shared_ptr<T>& v )
+         {
+            if( v ) write( *v );
+            else _out.write_null();
+         }
+
+         template<typename T>
+         void walk( const std::unique_ptr<T>& v )
+         {
+            if( v ) write( *v );
+            else _out.write_null();
+         }
+
+         template<typename T>
+         void walk( const safe<T>& v ) { write( v.value ); }
+
+         template<typename A, typename B>
+         void walk( const std::pair<A,B>& v )
+         {
+            _out.open( '[' );
+            write( v.first );
+            _out.separator();
+            write( v.second );
+            _out.close( ']' );
+         }
+
+         template<typename... T>
+         void walk( const static_variant<T...>& v )
+         {
+            _out.open( '[' );
+            write( variant( v.which() ) );
+            _out.separator();
+            v.visit( static_variant_writer( *this ) );
+            _out.close( ']' );
+         }
+
+         template<typename T>
+         void walk( const std::vector<T>& v )       { write_range( v ); }
+         template<typename T>
+         void walk( const std::deque<T>& v )        { write_range( v ); }
+         template<typename T>
+         void walk( const std::set<T>& v )          { write_range( v ); }
+         template<typename T>
+         void walk( const std::unordered_set<T>& v ){ write_range( v ); }
+         template<typename T>
+         void walk( const flat_set<T>& v )          { write_range( v ); }
+         template<typename K, typename T>
+         void walk( const std::map<K,T>& v )        { write_range( v ); }
+         template<typename K, typename T>
+         void walk( const std::multimap<K,T>& v )   { write_range( v ); }
+         template<typename T>
+         void walk( const std::map<string,T>& v )
+         {
+            _out.open( '{' );
+            for( auto itr = v.begin(); itr != v.end(); ++itr )
+            {
+               if( itr != v.begin() )
+                  _out.separator();
+               write( itr->first );
+               _out.key_separator();
+               write( itr->second );
+            }
+            _out.close( '}' );
+         }
+         template<typename K, typename T>
+         void walk( const std::unordered_map<K,T>& v ) { write_range( v ); }
+         template<typename K, typename... T>
+         void walk( const flat_map<K,T...>& v )     { write_range( v ); }
+
+         /** types without reflection that only the generic to_variant() matches, like integers */
+         template<typename T>
+         void walk_reflected( const T& v, std::false_type ) { write( variant( v ) ); }
+
+         template<typename T>
+         void walk_reflected( const T& v, std::true_type )
+         {
+            write_reflected( v, typename fc::reflector<T>::is_enum() );
+         }
+
+         template<typename T>
+         void write_reflected( const T& v, fc::true_type )
+         {
+            write( fc::reflector<T>::to_fc_string( v ) );
+         }
+
+         template<typename T>
+         void write_reflected( const T& v, fc::false_type )
+         {
+            _out.open( '{' );
+            fc::reflector<T>::visit( member_writer<T>( *this, v ) );
+            _out.close( '}' );
+         }
+
+         template<typename Range>
+         void write_range( const Range& r )
+         {
+            _out.open( '[' );
+            auto itr = r.begin();
+            while( itr != r.end() )
+            {
+               write( *itr );
+               ++itr;
+               if( itr != r.end() )
+                  _out.separator();
+               _out.maybe_flush();
+            }
+            _out.close( ']' );
+         }
+
+         json_buffer&              _out;
+         json::output_formatting   _format;
+   };
+
+   template<typename T>
+   string json::to_string( const T& v, output_formatting format )
+   {
+      string out;
+      to_string( v, out, format );
+      return out;
+   }
+
+   template<typename T>
+   void json::to_string( const T& v, string& out, output_formatting format )
+   {
+      json_buffer buffer( out );
+      json_writer( buffer, format ).write( v );
+   }
+
+   template<typename T>
+   string json::to_pretty_string( const T& v, output_formatting format )
+   {
+      string out;
+      json_buffer buffer( out, 2 );
+      json_writer( buffer, format ).write( v );
+      return out;
+   }
+
+} // fc
@@ -18,6 +18,101 @@
 namespace fc {
     namespace raw {
 
+    /** never defined, calls of pack() with it find the overloads of fc::raw by argument dependent lookup */
+    struct pack_probe_stream;
+
+    namespace detail {
+      namespace pack_probe
+      {
+         struct result {};
+
+         /** never defined, it has the signature of the generic pack() and only takes part in overload resolution */
+         template<typename Stream, typename T> result pack( Stream& s, const T& v );
+
+         template<typename T, typename = void>
+         struct is_ambiguous : std::true_type {};
+
+         template<typename T>
+         struct is_ambiguous<T, decltype( void( pack( std::declval<pack_probe_stream&>(), std::declval<const T&>() ) ) )>
+         : std::false_type {};
+      }
+
+      /**
+       *  True when T is packed by the generic pack() of fc::raw.  The probe of the same signature is
+       *  then ambiguous with it, while a pack() of T's own, like the one of an asset, is more
+       *  specialized and wins.
+       */
+      template<typename T>
+      struct uses_generic_pack : pack_probe::is_ambiguous<T> {};
+
+      template<size_t N>
+      struct fixed_pack_size    { static const bool is_fixed = true;  static const size_t value = N; };
+      struct variable_pack_size { static const bool is_fixed = false; static const size_t value = 0; };
+
+      template<typename T, typename Enable = void>
+      struct has_reflected_types : std::false_type {};
+      template<typename T>
+      struct has_reflected_types< T, typename std::conditional<true, void,
+                                          typename fc::reflector<T>::template types<T>::members>::type >
+         : std::true_type {};
+
+      /** the sum of Size<T> over the types of a std::tuple, if all of them are fixed */
+      template<template<typename> class Size, typename Tuple>
+      struct pack_size_sum;
+      template<template<typename> class Size>
+      struct pack_size_sum< Size, std::tuple<> > : fixed_pack_size<0> {};
+      template<template<typename> class Size, typename T, typename... Rest>
+      struct pack_size_sum< Size, std::tuple<T,Rest...> >
+         : std::conditional< Size<T>::is_fixed && pack_size_sum< Size, std::tuple<Rest...> >::is_fixed,
+                             fixed_pack_size< Size<T>::value + pack_size_sum< Size, std::tuple<Rest...> >::value >,
+                             variable_pack_size >::type {};
+
+      template<typename T>
+      struct member_pack_size : static_pack_size<T> {};
+
+      /** what pack_object_visitor writes: the members of the bases, then those of T */
+      template<typename T>
+      struct reflected_pack_size
+         : std::conditional< pack_size_sum< reflected_pack_size, typename fc::reflector<T>::template types<T>::bases >::is_fixed
+                             && pack_size_sum< member_pack_size, typename fc::reflector<T>::template types<T>::members >::is_fixed,
+                             fixed_pack_size< pack_size_sum< reflected_pack_size, typename fc::reflector<T>::template types<T>::bases >::value
+                                            + pack_size_sum< member_pack_size, typename fc::reflector<T>::template types<T>::members >::value >,
+                             variable_pack_size >::type {};
+    } // namespace detail
+
+    /**
+     *  static_pack_size<T>::is_fixed is true when every packed T has the same size, which is then
+     *  static_pack_size<T>::value, so pack_size() and pack() know it without a test run.  That is
+     *  the case for arithmetic types and enums, time points, the types is_trivially_packed marks,
+     *  and reflected structs of only such members.  A reflected type with a pack() of its own is
+     *  variable unless it specializes static_pack_size.
+     */
+    template<typename T, typename Enable>
+    struct static_pack_size : detail::variable_pack_size {};
+
+    template<typename T>
+    struct static_pack_size< T, typename std::enable_if< std::is_arithmetic<T>::value >::type >
+       : detail::fixed_pack_size< std::is_same<T,bool>::value ? 1 : sizeof(T) > {};
+
+    /** reflected enums are packed as int64_t, others as their memory */
+    template<typename T>
+    struct static_pack_size< T, typename std::enable_if< std::is_enum<T>::value >::type >
+       : detail::fixed_pack_size< fc::reflector<T>::is_enum::value ? sizeof(int64_t) : sizeof(T) > {};
+
+    template<typename T>
+    struct static_pack_size< T, typename std::enable_if< std::is_class<T>::value && is_trivially_packed<T>::value >::type >
+       : detail::fixed_pack_size< sizeof(T) > {};
+
+    template<typename T>
+    struct static_pack_size< T, typename std::enable_if< std::is_class<T>::value && !is_trivially_packed<T>::value
+                                                         && detail::has_reflected_types<T>::value
+                                                         && detail::uses_generic_pack<T>::value >::type >
+       : detail::reflected_pack_size<T> {};
+
+    template<> struct static_pack_size<fc::time_point_sec> : detail::fixed_pack_size<sizeof(uint32_t)> {};
+    template<> struct static_pack_size<fc::time_point>     : detail::fixed_pack_size<sizeof(uint64_t)> {};
+    template<> struct static_pack_size<fc::microseconds>   : detail::fixed_pack_size<sizeof(uint64_t)> {};
+
     template<typename Stream, typename Arg0, typename... Args>
     inline void pack( Stream& s, const Arg0& a0, Args... args ) {
        pack( s, a0 );
@@ -249,10 +344,11 @@ namespace fc {
     }
 
     template<typename Stream> inline void unpack( Stream& s, fc::string& v )  {
-      std::vector<char> tmp; fc::raw::unpack(s,tmp);
-      if( tmp.size() )
-         v = fc::string(tmp.data(),tmp.data()+tmp.size());
-      else v = fc::string();
+      unsigned_int size; fc::raw::unpack( s, size );
+      FC_ASSERT( size.value < MAX_ARRAY_ALLOC_SIZE );
+      v.resize(size.value);
+      if( v.size() )
+         s.read( &v[0], v.size() );
     }
 
     // bool
@@ -364,6 +460,59 @@ namespace fc {
         }
       };
 
+      /** calls f( first, n ) for each run of elements of @a d that lie next to each other in memory */
+      template<typename Deque, typename F>
+      inline void for_each_run( Deque& d, F&& f ) {
+        const size_t size = d.size();
+        for( size_t i = 0; i < size; ) {
+          auto* first = &d[i];
+          size_t n = 1;
+          while( i + n < size && &d[i + n] == first + n )
+            ++n;
+          f( first, n );
+          i += n;
+        }
+      }
+
+      /**
+       *  Packs the elements of a vector or a deque one at a time, or with one write per contiguous
+       *  range of them if is_trivially_packed says their packed form is their memory.
+       */
+      template<typename Stream, typename Container>
+      inline void pack_elements( Stream& s, const Container& value, std::false_type ) {
+        for( const auto& e : value )
+          fc::raw::pack( s, e );
+      }
+      template<typename Stream, typename T>
+      inline void pack_elements( Stream& s, const std::vector<T>& value, std::true_type ) {
+        if( !value.empty() )
+          s.write( (const char*)value.data(), value.size() * sizeof(T) );
+      }
+      template<typename Stream, typename T>
+      inline void pack_elements( Stream& s, const std::deque<T>& value, std::true_type ) {
+        for_each_run( value, [&]( const T* first, size_t n ) {
+          s.write( (const char*)first, n * sizeof(T) );
+        });
+      }
+
+      /** the counterpart of pack_elements, for a container already resized to the packed size */
+      template<typename Stream, typename Container>
+      inline void unpack_elements( Stream& s, Container& value, std::false_type ) {
+        for( auto& e : value )
+          fc::raw::unpack( s, e );
+      }
+      template<typename Stream, typename T>
+      inline void unpack_elements( Stream& s, std::vector<T>& value, std::true_type ) {
+        if( !value.empty() )
+          s.read( (char*)value.data(), value.size() * sizeof(T) );
+      }
+      template<typename Stream, typename T>
+      inline void unpack_elements( Stream& s, std::deque<T>& value, std::true_type ) {
+        for_each_run( value, [&]( T* first, size_t n ) {
+          s.read( (char*)first, n * sizeof(T) );
+        });
+      }
+
     } // namesapce detail
 
     template<typename Stream, typename T>
@@ -454,12 +603,7 @@ namespace fc {
     template<typename Stream, typename T>
     inline void pack( Stream& s, const std::deque<T>& value ) {
       fc::raw::pack( s, unsigned_int((uint32_t)value.size()) );
-      auto itr = value.begin();
-      auto end = value.end();
-      while( itr != end ) {
-        fc::raw::pack( s, *itr );
-        ++itr;
-      }
+      detail::pack_elements( s, value, typename is_trivially_packed<T>::type() );
     }
 
     template<typename Stream, typename T>
@@ -467,23 +611,13 @@ namespace fc {
       unsigned_int size; fc::raw::unpack( s, size );
       FC_ASSERT( size.value*sizeof(T) < MAX_ARRAY_ALLOC_SIZE );
       value.resize(size.value);
-      auto itr = value.begin();
-      auto end = value.end();
-      while( itr != end ) {
-        fc::raw::unpack( s, *itr );
-        ++itr;
-      }
+      detail::unpack_elements( s, value, typename is_trivially_packed<T>::type() );
     }
 
     template<typename Stream, typename T>
     inline void pack( Stream& s, const std::vector<T>& value ) {
       fc::raw::pack( s, unsigned_int((uint32_t)value.size()) );
-      auto itr = value.begin();
-      auto end = value.end();
-      while( itr != end ) {
-        fc::raw::pack( s, *itr );
-        ++itr;
-      }
+      detail::pack_elements( s, value, typename is_trivially_packed<T>::type() );
     }
 
     template<typename Stream, typename T>
@@ -491,12 +625,7 @@ namespace fc {
       unsigned_int size; fc::raw::unpack( s, size );
       FC_ASSERT( size.value*sizeof(T) < MAX_ARRAY_ALLOC_SIZE );
       value.resize(size.value);
-      auto itr = value.begin();
-      auto end = value.end();
-      while( itr != end ) {
-        fc::raw::unpack( s, *itr );
-        ++itr;
-      }
+      detail::unpack_elements( s, value, typename is_trivially_packed<T>::type() );
     }
 
     template<typename Stream, typename T>
@@ -536,6 +665,8 @@ namespace fc {
     template<typename T>
     inline size_t pack_size(  const T& v )
     {
+      if( static_pack_size<T>::is_fixed )
+        return static_pack_size<T>::value;
       datastream<size_t> ps;
       fc::raw::pack(ps,v );
       return ps.tellp();
@@ -543,13 +674,13 @@ namespace fc {
 
     template<typename T>
     inline std::vector<char> pack(  const T& v ) {
-      datastream<size_t> ps;
-      fc::raw::pack(ps,v );
-      std::vector<char> vec(ps.tellp());
+      std::vector<char> vec( fc::raw::pack_size(v) );
 
       if( vec.size() ) {
         datastream<char*>  ds( vec.data(), size_t(vec.size()) );
         fc::raw::pack(ds,v);
+        FC_ASSERT( ds.tellp() == vec.size(), "pack() wrote a size other than pack_size()",
+                   ("written",ds.tellp())("size",vec.size()) );
       }
       return vec;
     }
@@ -10,6 +10,7 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <set>
+#include <type_traits>
 
 #define MAX_ARRAY_ALLOC_SIZE (1024*1024*10) 
 
@@ -26,8 +27,23 @@ namespace fc {
 
    namespace ecc { class public_key; class private_key; }
    template<typename Storage> class fixed_string;
+   template<typename T> class datastream;
 
    namespace raw {
+    /**
+     *  True for the types whose packed form is exactly their memory, so that vectors and deques of
+     *  them are packed and unpacked with one write or read per contiguous range of elements rather
+     *  than one per element.  Specialize it next to the pack and unpack of such a type.
+     */
+    template<typename T>
+    struct is_trivially_packed : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T,bool>::value> {};
+    template<typename T, size_t N>
+    struct is_trivially_packed< fc::array<T,N> >
+       : std::integral_constant<bool, is_trivially_packed<T>::value && sizeof(fc::array<T,N>) == N * sizeof(T)> {};
+
+    /** the size of every packed T when that is known at compile time, see raw.hpp */
+    template<typename T, typename Enable = void> struct static_pack_size;
+
     template<typename T>
     inline size_t pack_size(  const T& v );
 
@@ -117,6 +133,15 @@ namespace fc {
     template<typename Stream> inline void pack( Stream& s, const bool& v );
     template<typename Stream> inline void unpack( Stream& s, bool& v );
 
+    class byte_view;
+    class string_view;
+    template<typename Stream> inline void pack( Stream& s, const byte_view& v );
+    template<typename Stream> inline void pack( Stream& s, const string_view& v );
+    inline void unpack( datastream<const char*>& s, byte_view& v );
+    inline void unpack( datastream<char*>& s, byte_view& v );
+    inline void unpack( datastream<const char*>& s, string_view& v );
+    inline void unpack( datastream<char*>& s, string_view& v );
+
     template<typename T> inline std::vector<char> pack( const T& v );
     template<typename T> inline T unpack( const std::vector<char>& s );
     template<typename T> inline T unpack( const char* d, uint32_t s );
@@ -0,0 +1,194 @@
+#pragma once
+#include <fc/io/raw.hpp>
+#include <fc/container/flat.hpp>
+#include <fc/static_variant.hpp>
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+
+namespace fc { namespace raw {
+
+   template<typename T, typename Stream> inline void skip( Stream& s );
+
+   namespace detail {
+
+      /** moves @a s past @a n bytes, with the range check of reading them */
+      template<typename Stream>
+      inline void skip_bytes( Stream& s, uint64_t n )
+      {
+         if( s.remaining() < n )
+            fc::detail::throw_datastream_range_error( "skip", s.remaining(), int64_t( n - s.remaining() ) );
+         s.skip( n );
+      }
+
+      /** moves @a s past @a n packed Ts, at once if they all have the same size */
+      template<typename T, typename Stream>
+      inline void skip_elements( Stream& s, uint64_t n )
+      {
+         if( static_pack_size<T>::is_fixed )
+            return skip_bytes( s, n * static_pack_size<T>::value );
+         for( uint64_t i = 0; i < n; ++i )
+            fc::raw::skip<T>( s );
+      }
+
+      template<typename Stream>
+      struct skip_object_visitor {
+         skip_object_visitor( Stream& _s ):s(_s){}
+
+         template<typename T, typename C, T(C::*p)>
+         void operator()( const char* name )const
+         { try {
+            fc::raw::skip<T>( s );
+         } FC_RETHROW_EXCEPTIONS( warn, "Error skipping field ${field}", ("field",name) ) }
+         private:
+            Stream& s;
+      };
+
+      /**
+       *  Skips a T of a static size by its size, a reflected struct packed by the generic pack()
+       *  member by member, and anything else by unpacking it into a temporary.  The containers that are packed with
+       *  their length first are specialized below.
+       */
+      template<typename T, typename Enable = void>
+      struct skipper {
+         template<typename Stream>
+         static void skip( Stream& s ) {
+            skip( s, std::integral_constant<int, static_pack_size<T>::is_fixed ? 0 :
+                                                 has_reflected_types<T>::value && uses_generic_pack<T>::value ? 1 : 2>() );
+         }
+         template<typename Stream>
+         static void skip( Stream& s, std::integral_constant<int,0> ) {
+            skip_bytes( s, static_pack_size<T>::value );
+         }
+         template<typename Stream>
+         static void skip( Stream& s, std::integral_constant<int,1> ) {
+            fc::reflector<T>::visit( skip_object_visitor<Stream>( s ) );
+         }
+         template<typename Stream>
+         static void skip( Stream& s, std::integral_constant<int,2> ) {
+            T tmp;
+            fc::raw::unpack( s, tmp );
+         }
+      };
+
+      /**
+       *  the containers packed as their length and then their elements, the length is bounded
+       *  by MAX_ARRAY_ALLOC_SIZE / ElementSize as unpack() bounds it, 0 leaves it unbounded
+       */
+      template<typename Element, size_t ElementSize = sizeof(Element)>
+      struct skip_sequence {
+         template<typename Stream>
+         static void skip( Stream& s ) {
+            unsigned_int size; fc::raw::unpack( s, size );
+            FC_ASSERT( ElementSize == 0 || size.value*ElementSize < MAX_ARRAY_ALLOC_SIZE );
+            skip_elements<Element>( s, size.value );
+         }
+      };
+
+      template<> struct skipper<fc::string> : skip_sequence<char> {};
+      template<typename T, typename A> struct skipper< std::vector<T,A> > : skip_sequence<T> {};
+      template<typename T, typename A> struct skipper< std::deque<T,A> > : skip_sequence<T> {};
+      template<typename T, typename... A> struct skipper< std::set<T,A...> > : skip_sequence<T,0> {};
+      template<typename T, typename... A> struct skipper< std::unordered_set<T,A...> > : skip_sequence<T> {};
+      template<typename T, typename... A> struct skipper< flat_set<T,A...> > : skip_sequence<T> {};
+      template<typename K, typename V, typename... A> struct skipper< std::map<K,V,A...> > : skip_sequence< std::pair<K,V>, sizeof(K)+sizeof(V) > {};
+      template<typename K, typename V, typename... A> struct skipper< std::unordered_map<K,V,A...> > : skip_sequence< std::pair<K,V>, sizeof(K)+sizeof(V) > {};
+      template<typename K, typename V, typename... A> struct skipper< flat_map<K,V,A...> > : skip_sequence< std::pair<K,V>, sizeof(K)+sizeof(V) > {};
+
+      template<typename K, typename V>
+      struct skipper< std::pair<K,V> > {
+         template<typename Stream>
+         static void skip( Stream& s ) {
+            fc::raw::skip<K>( s );
+            fc::raw::skip<V>( s );
+         }
+      };
+
+      template<typename T>
+      struct skipper< fc::optional<T> > {
+         template<typename Stream>
+         static void skip( Stream& s ) {
+            bool b; fc::raw::unpack( s, b );
+            if( b )
+               fc::raw::skip<T>( s );
+         }
+      };
+
+      template<typename... T>
+      struct skipper< static_variant<T...> > {
+         template<typename Stream>
+         static void skip( Stream& s ) {
+            unsigned_int w; fc::raw::unpack( s, w );
+            typedef void (*skip_one)( Stream& );
+            static const skip_one skips[] = { &fc::raw::skip<T,Stream>... };
+            FC_ASSERT( w.value < sizeof...(T), "Invalid static_variant tag ${w}", ("w",w.value) );
+            skips[w.value]( s );
+         }
+      };
+
+      template<typename M, typename C>
+      inline bool same_member( M C::* a, M C::* b ) { return a == b; }
+      template<typename M, typename C, typename P>
+      inline bool same_member( M C::*, P ) { return false; }
+
+      template<typename Stream, typename Class, typename... Members>
+      struct unpack_members_visitor {
+         unpack_members_visitor( Class& _c, Stream& _s, const std::tuple<Members...>& _m )
+         :c(_c),s(_s),members(_m){}
+
+         template<typename T, typename C, T(C::*p)>
+         void operator()( const char* name )const
+         { try {
+            if( selected( p, std::index_sequence_for<Members...>() ) )
+               fc::raw::unpack( s, c.*p );
+            else
+               fc::raw::skip<T>( s );
+         } FC_RETHROW_EXCEPTIONS( warn, "Error unpacking field ${field}", ("field",name) ) }
+
+         private:
+            template<typename P, size_t... I>
+            bool selected( P p, std::index_sequence<I...> )const {
+               bool found = false;
+               (void)std::initializer_list<int>{ 0, ( found = found || same_member( p, std::get<I>( members ) ), 0 )... };
+               return found;
+            }
+
+            Class&                        c;
+            Stream&                       s;
+            const std::tuple<Members...>& members;
+      };
+
+   } // namespace detail
+
+   /**
+    *  Moves @a s past a packed T without building it: a T of a static size by its size, the
+    *  containers packed with their length by their elements, optionals and static_variants by
+    *  what they hold, and reflected structs member by member.  Anything else, reflected types
+    *  with a pack() of their own included, is unpacked into a temporary.  @a s is a datastream
+    *  over memory.
+    */
+   template<typename T, typename Stream>
+   inline void skip( Stream& s )
+   {
+      detail::skipper<T>::skip( s );
+   }
+
+   /**
+    *  Unpacks only the @a members of a packed reflected struct into @a obj, given as member
+    *  pointers such as &T::timestamp, and skips the others.  The members of the bases of T can
+    *  be given as well.  @a s is left after the whole struct, so it can be called for one
+    *  packed record after another.  T has to be packed by the generic pack(), as its members.
+    *
+    *  @code
+    *  fc::raw::unpack_members( ds, op, &operation::type, &operation::timestamp );
+    *  @endcode
+    */
+   template<typename Stream, typename T, typename... Members>
+   inline void unpack_members( Stream& s, T& obj, Members... members )
+   { try {
+      static_assert( detail::uses_generic_pack<T>::value, "unpack_members() needs a type packed as its members" );
+      const std::tuple<Members...> selected( members... );
+      fc::reflector<T>::visit( detail::unpack_members_visitor<Stream,T,Members...>( obj, s, selected ) );
+   } FC_RETHROW_EXCEPTIONS( warn, "error unpacking members of ${type}", ("type",fc::get_typename<T>::name() ) ) }
+
+} } // fc::raw
@@ -20,5 +20,16 @@ namespace fc
                fc::raw::unpack(ds,obj);
            } FC_RETHROW_EXCEPTIONS( info, "unpacking file ${file}", ("file",filename) );
         }
+
+        /**
+         *  Unpacks what @a region holds.  Unlike unpack_file() the caller keeps the mapping, so
+         *  byte_views and string_views in @a obj point into it and are valid while it is mapped.
+         */
+        template<typename T>
+        void unpack_region( const fc::mapped_region& region, T& obj )
+        {
+           fc::datastream<const char*> ds( (const char*)region.get_address(), region.get_size() );
+           fc::raw::unpack(ds,obj);
+        }
    }
 }
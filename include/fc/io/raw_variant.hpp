@@ -3,43 +3,50 @@
 #include <fc/io/raw_fwd.hpp>
 #include <fc/variant_object.hpp>
 #include <fc/variant.hpp>
+#include <fc/variant_limits.hpp>
 
 namespace fc { namespace raw {
 
+    /** packs the value of a variant, used with variant::visit( F&& ) */
     template<typename Stream>
-    class variant_packer : public variant::visitor
+    class variant_packer
     {
        public:
          variant_packer( Stream& _s ):s(_s){}
-         virtual void handle()const { }
-         virtual void handle( const int64_t& v )const
+         void operator()()const { }
+         void operator()( int64_t v )const
          {
             fc::raw::pack( s, v );
          }
-         virtual void handle( const uint64_t& v )const
+         void operator()( uint64_t v )const
          {
             fc::raw::pack( s, v );
          }
-         virtual void handle( const double& v )const 
+         void operator()( double v )const 
          {
             fc::raw::pack( s, v );
          }
-         virtual void handle( const bool& v )const
+         void operator()( bool v )const
          {
             fc::raw::pack( s, v );
          }
-         virtual void handle( const string& v )const
+         void operator()( const string& v )const
          {
             fc::raw::pack( s, v );
          }
-         virtual void handle( const variant_object& v)const
+         void operator()( const variant_object& v)const
          {
             fc::raw::pack( s, v );
          }
-         virtual void handle( const variants& v)const
+         void operator()( const variants& v)const
          {
             fc::raw::pack( s, v );
          }
+         /// blobs have no packed form
+         void operator()( const blob& )const
+         {
+            FC_THROW_EXCEPTION( assert_exception, "Invalid Type / Corrupted Memory" );
+         }
         
          Stream& s;
         
@@ -52,69 +59,83 @@ namespace fc { namespace raw {
        pack( s, uint8_t(v.get_type()) );
        v.visit( variant_packer<Stream>(s) );
     }
-    template<typename Stream> 
-    inline void unpack( Stream& s, variant& v )
+    template<typename Stream>
+    inline variant unpack_variant_value( Stream& s )
     {
       uint8_t t;
       unpack( s, t );
       switch( t )
       {
          case variant::null_type:
-            return;
+            return variant();
          case variant::int64_type:
          {
             int64_t val;
             raw::unpack(s,val);
-            v = val;
-            return;
+            return val;
          }
          case variant::uint64_type:
          {
             uint64_t val;
             raw::unpack(s,val);
-            v = val;
-            return;
+            return val;
          }
          case variant::double_type:
          {
             double val;
             raw::unpack(s,val);
-            v = val;
-            return;
+            return val;
          }
          case variant::bool_type:
          {
             bool val;
             raw::unpack(s,val);
-            v = val;
-            return;
+            return val;
          }
          case variant::string_type:
          {
             fc::string val;
             raw::unpack(s,val);
-            v = fc::move(val);
-            return;
+            return fc::move(val);
          }
          case variant::array_type:
          {
-            variants val;
-            raw::unpack(s,val);
-            v = fc::move(val);
-            return;
+            unsigned_int size;
+            raw::unpack( s, size );
+            FC_ASSERT( size.value*sizeof(variant) < MAX_ARRAY_ALLOC_SIZE );
+            if( parse_budget* budget = parse_budget::current() )
+               budget->check_bytes( size.value*sizeof(variant) );
+            variants val( size.value );
+            for( auto& item : val )
+               raw::unpack( s, item );
+            return fc::move(val);
          }
          case variant::object_type:
          {
             variant_object val; 
             raw::unpack(s,val);
-            v = fc::move(val);
-            return;
+            return fc::move(val);
          }
          default:
             FC_THROW_EXCEPTION( parse_error_exception, "Unknown Variant Type ${t}", ("t", t) );
       }
     }
 
+    /** every value is charged to the parse_budget of the thread, if any */
+    template<typename Stream> 
+    inline void unpack( Stream& s, variant& v )
+    {
+       v = budgeted_parse( [&]() { return unpack_variant_value( s ); } );
+    }
+
+    /** unpacks @a v and fails once the tree exceeds one of @a limits */
+    template<typename Stream>
+    inline void unpack( Stream& s, variant& v, const parse_limits& limits )
+    {
+       parse_budget budget( limits );
+       unpack( s, v );
+    }
+
     template<typename Stream> 
     inline void pack( Stream& s, const variant_object& v ) 
     {
@@ -132,6 +153,8 @@ namespace fc { namespace raw {
        unsigned_int vs;
        unpack( s, vs );
 
+       if( parse_budget* budget = parse_budget::current() )
+          budget->check_bytes( vs.value * sizeof(variant_object::entry) );
        mutable_variant_object mvo;
        mvo.reserve(vs.value);
        for( uint32_t i = 0; i < vs.value; ++i )
@@ -0,0 +1,121 @@
+#pragma once
+#include <fc/io/raw.hpp>
+#include <fc/string.hpp>
+#include <string.h>
+
+namespace fc { namespace raw {
+
+   /**
+    *  Bytes packed like a std::vector<char> that stay where they are in the buffer they were
+    *  unpacked from.  unpack() fills it from a datastream over memory without allocating or
+    *  copying, so it is only valid while that buffer is, e.g. the std::vector<char> passed to
+    *  raw::unpack() or the mapped_region passed to raw::unpack_region().  Packing one writes the
+    *  same bytes a std::vector<char> with its contents would.
+    */
+   class byte_view
+   {
+      public:
+         byte_view():_data(nullptr),_size(0){}
+         byte_view( const char* data, size_t size ):_data(data),_size(size){}
+         byte_view( const std::vector<char>& v ):_data(v.data()),_size(v.size()){}
+
+         const char* data()const  { return _data;          }
+         size_t      size()const  { return _size;          }
+         bool        empty()const { return _size == 0;     }
+         const char* begin()const { return _data;          }
+         const char* end()const   { return _data + _size;  }
+         char operator[]( size_t i )const { return _data[i]; }
+
+         std::vector<char> to_vector()const { return std::vector<char>( begin(), end() ); }
+
+         friend bool operator == ( const byte_view& a, const byte_view& b )
+         {
+            return a._size == b._size && ( a._size == 0 || memcmp( a._data, b._data, a._size ) == 0 );
+         }
+         friend bool operator != ( const byte_view& a, const byte_view& b ) { return !( a == b ); }
+
+      private:
+         const char* _data;
+         size_t      _size;
+   };
+
+   /** the counterpart of byte_view for text packed like a fc::string */
+   class string_view
+   {
+      public:
+         string_view():_data(nullptr),_size(0){}
+         string_view( const char* data, size_t size ):_data(data),_size(size){}
+         string_view( const fc::string& s ):_data(s.data()),_size(s.size()){}
+
+         const char* data()const  { return _data;          }
+         size_t      size()const  { return _size;          }
+         bool        empty()const { return _size == 0;     }
+         const char* begin()const { return _data;          }
+         const char* end()const   { return _data + _size;  }
+         char operator[]( size_t i )const { return _data[i]; }
+
+         fc::string str()const { return fc::string( begin(), end() ); }
+
+         friend bool operator == ( const string_view& a, const string_view& b )
+         {
+            return a._size == b._size && ( a._size == 0 || memcmp( a._data, b._data, a._size ) == 0 );
+         }
+         friend bool operator != ( const string_view& a, const string_view& b ) { return !( a == b ); }
+         friend bool operator < ( const string_view& a, const string_view& b )
+         {
+            const int c = memcmp( a._data, b._data, a._size < b._size ? a._size : b._size );
+            return c < 0 || ( c == 0 && a._size < b._size );
+         }
+
+      private:
+         const char* _data;
+         size_t      _size;
+   };
+
+   namespace detail {
+      /** the next @a size chars of @a s, which it then skips, with the checks of unpacking a vector */
+      template<typename T>
+      inline const char* view_next( datastream<T>& s, size_t size )
+      {
+         FC_ASSERT( size < MAX_ARRAY_ALLOC_SIZE );
+         if( s.remaining() < size )
+            fc::detail::throw_datastream_range_error( "view", s.remaining(), int64_t( size - s.remaining() ) );
+         const char* data = s.pos();
+         s.skip( size );
+         return data;
+      }
+   }
+
+   template<typename Stream> inline void pack( Stream& s, const byte_view& v ) {
+      fc::raw::pack( s, unsigned_int((uint32_t)v.size()) );
+      if( v.size() )
+         s.write( v.data(), v.size() );
+   }
+   template<typename Stream> inline void pack( Stream& s, const string_view& v ) {
+      fc::raw::pack( s, unsigned_int((uint32_t)v.size()) );
+      if( v.size() )
+         s.write( v.data(), v.size() );
+   }
+
+   /** only streams over memory can be viewed, others do not keep what they have read */
+   inline void unpack( datastream<const char*>& s, byte_view& v ) {
+      unsigned_int size; fc::raw::unpack( s, size );
+      v = byte_view( detail::view_next( s, size.value ), size.value );
+   }
+   inline void unpack( datastream<char*>& s, byte_view& v ) {
+      unsigned_int size; fc::raw::unpack( s, size );
+      v = byte_view( detail::view_next( s, size.value ), size.value );
+   }
+   inline void unpack( datastream<const char*>& s, string_view& v ) {
+      unsigned_int size; fc::raw::unpack( s, size );
+      v = string_view( detail::view_next( s, size.value ), size.value );
+   }
+   inline void unpack( datastream<char*>& s, string_view& v ) {
+      unsigned_int size; fc::raw::unpack( s, size );
+      v = string_view( detail::view_next( s, size.value ), size.value );
+   }
+
+} } // fc::raw
+
+FC_REFLECT_TYPENAME( fc::raw::byte_view )
+FC_REFLECT_TYPENAME( fc::raw::string_view )
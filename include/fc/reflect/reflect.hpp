@@ -9,12 +9,15 @@
 #include <fc/utility.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/seq/for_each_i.hpp>
+#include <boost/preprocessor/punctuation/comma_if.hpp>
 #include <boost/preprocessor/seq/enum.hpp>
 #include <boost/preprocessor/seq/size.hpp>
 #include <boost/preprocessor/seq/seq.hpp>
 #include <boost/preprocessor/stringize.hpp>
 #include <stdint.h>
 #include <string.h>
+#include <tuple>
 
 #include <fc/reflect/typename.hpp>
 
@@ -60,6 +63,17 @@ struct reflector{
     #ifdef DOXYGEN
     template<typename Visitor>
     static inline void visit( const Visitor& v );
+
+    /**
+     *  The base classes and the types of the members of T as std::tuples, in the order visit()
+     *  passes them, for traits computed at compile time.  A template so that the member types
+     *  are only named where a trait asks for them.  Not defined by FC_REFLECT_FWD.
+     */
+    template<typename Type = T>
+    struct types {
+       typedef std::tuple<...> bases;
+       typedef std::tuple<...> members;
+    };
     #endif // DOXYGEN
 };
 
@@ -94,6 +108,18 @@ void throw_bad_enum_cast( const char* k, const char* e );
 #define FC_REFLECT_MEMBER_COUNT( r, OP, elem ) \
   OP 1
 
+#define FC_REFLECT_BASE_TYPE( r, data, i, base ) \
+  BOOST_PP_COMMA_IF(i) base
+
+#define FC_REFLECT_MEMBER_TYPE( r, data, i, elem ) \
+  BOOST_PP_COMMA_IF(i) decltype(((Type*)nullptr)->elem)
+
+#define FC_REFLECT_DERIVED_TYPES( INHERITS, MEMBERS ) \
+template<typename Type = type> struct types { \
+    typedef std::tuple< BOOST_PP_SEQ_FOR_EACH_I( FC_REFLECT_BASE_TYPE, _, INHERITS ) > bases; \
+    typedef std::tuple< BOOST_PP_SEQ_FOR_EACH_I( FC_REFLECT_MEMBER_TYPE, _, MEMBERS ) > members; \
+};
+
 #define FC_REFLECT_DERIVED_IMPL_INLINE( TYPE, INHERITS, MEMBERS ) \
 template<typename Visitor>\
 static inline void visit( const Visitor& v ) { \
@@ -210,6 +236,7 @@ template<> struct reflector<TYPE> {\
       local_member_count = 0  BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_MEMBER_COUNT, +, MEMBERS ),\
       total_member_count = local_member_count BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_BASE_MEMBER_COUNT, +, INHERITS )\
     }; \
+    FC_REFLECT_DERIVED_TYPES( INHERITS, MEMBERS ) \
     FC_REFLECT_DERIVED_IMPL_INLINE( TYPE, INHERITS, MEMBERS ) \
 }; }
 #define FC_REFLECT_DERIVED_TEMPLATE( TEMPLATE_ARGS, TYPE, INHERITS, MEMBERS ) \
@@ -223,6 +250,7 @@ template<BOOST_PP_SEQ_ENUM(TEMPLATE_ARGS)> struct reflector<TYPE> {\
       local_member_count = 0  BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_MEMBER_COUNT, +, MEMBERS ),\
       total_member_count = local_member_count BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_BASE_MEMBER_COUNT, +, INHERITS )\
     }; \
+    FC_REFLECT_DERIVED_TYPES( INHERITS, MEMBERS ) \
     FC_REFLECT_DERIVED_IMPL_INLINE( TYPE, INHERITS, MEMBERS ) \
 }; }
 
@@ -28,11 +28,11 @@ namespace fc
          void add( mutable_variant_object& vo, const char* name, const optional<M>& v )const
          { 
             if( v.valid() )
-               vo(name,*v);
+               vo(static_key(name),*v);
          }
          template<typename M>
          void add( mutable_variant_object& vo, const char* name, const M& v )const
-         { vo(name,v); }
+         { vo(static_key(name),v); }
 
          mutable_variant_object& vo;
          const T& val;
@@ -64,6 +64,7 @@ namespace fc
      static inline void to_variant( const T& v, fc::variant& vo ) 
      { 
          mutable_variant_object mvo;
+         mvo.reserve( fc::reflector<T>::total_member_count );
          fc::reflector<T>::visit( to_variant_visitor<T>( mvo, v ) );
          vo = fc::move(mvo);
      }
@@ -87,7 +88,7 @@ namespace fc
        static inline void from_variant( const fc::variant& v, T& o ) 
        { 
            if( v.is_string() )
-              o = fc::reflector<T>::from_string( v.get_string().c_str() );
+              o = fc::reflector<T>::from_string( v.as_string().c_str() );
            else
               o = fc::reflector<T>::from_int( v.as_int64() );
        }
@@ -2,6 +2,7 @@
 
 #include <fc/io/raw_fwd.hpp>
 #include <fc/variant.hpp>
+#include <fc/exception/exception.hpp>
 #include <fc/shared_containers.hpp>
 
 namespace fc {
@@ -16,6 +17,7 @@ namespace raw {
         raw.resize(size);
         datastream<char*> ds(raw.data(), size);
         pack(ds, v);
+        FC_ASSERT(ds.tellp() == size, "pack() wrote a size other than pack_size()", ("written", ds.tellp())("size", size));
     }
 
     template <typename T> inline void unpack(const shared_buffer& raw, T& v)
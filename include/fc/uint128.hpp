@@ -5,6 +5,7 @@
 
 #include <fc/exception/exception.hpp>
 #include <fc/crypto/city.hpp>
+#include <fc/io/raw_fwd.hpp>
 
 #ifdef _MSC_VER
   #pragma warning (push)
@@ -129,6 +130,9 @@ namespace fc
     inline void pack( Stream& s, const uint128& u ) { s.write( (char*)&u, sizeof(u) ); }
     template<typename Stream>
     inline void unpack( Stream& s, uint128& u ) { s.read( (char*)&u, sizeof(u) ); }
+
+    /** packed as its memory by the pack() above rather than as its reflected members */
+    template<> struct is_trivially_packed<uint128> : std::integral_constant<bool, sizeof(uint128) == 16> {};
   }
 
   size_t city_hash_size_t(const char *buf, size_t len);
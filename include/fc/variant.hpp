@@ -1,5 +1,6 @@
 #pragma once 
 
+#include <atomic>
 #include <deque>
 #include <map>
 #include <memory>
@@ -9,6 +10,7 @@
 #include <vector>
 
 #include <string.h> // memset
+#include <type_traits>
 
 #include <fc/optional.hpp>
 #include <fc/string.hpp>
@@ -44,6 +46,33 @@ namespace fc
 
    struct blob { std::vector<char> data; };
 
+   namespace detail
+   {
+      struct arena_blocks;
+
+      /**
+       *  Strings, blobs, arrays and objects are kept in reference counted payloads so
+       *  copying a variant shares the value instead of copying it.  The non-const
+       *  accessors clone a payload that is shared, and mark the payload as no longer
+       *  shareable: writes through the returned reference must not show up in copies
+       *  made afterwards, so those get a payload of their own.
+       */
+      template<typename T>
+      struct variant_payload
+      {
+         template<typename... Args>
+         explicit variant_payload( Args&&... args ) : value( std::forward<Args>(args)... ) {}
+
+         std::atomic<int32_t> ref_count{1};
+         bool                 shareable = true;
+         arena_blocks*        arena = nullptr; ///< set when allocated from a variant_arena
+         T                    value;
+      };
+
+      /** set in the TypeID of strings that are stored in the variant itself */
+      const uint8_t inline_string_flag = 0x80;
+   }
+
    void to_variant( const blob& var,  variant& vo );
    void from_variant( const variant& var,  blob& vo );
 
@@ -166,7 +195,13 @@ namespace fc
     *        and variant_object's.  
     *
     * variant's allocate everything but strings, arrays, and objects on the
-    * stack and are 'move aware' for values allcoated on the heap.  
+    * stack and are 'move aware' for values allcoated on the heap.  Strings
+    * short enough to fit in the variant itself are not allocated either.
+    *
+    * Heap allocated values are reference counted and shared between copies of
+    * a variant.  The non-const accessors get_array(), get_object() and
+    * get_blob() clone a shared value before returning it, and values that have
+    * been returned by them are copied rather than shared by later copies.
     *
     * Memory usage on 64 bit systems is 16 bytes and 12 bytes on 32 bit systems.
     */
@@ -236,6 +271,17 @@ namespace fc
 
         void  visit( const visitor& v )const;
 
+        /**
+         *  Calls @a f with the value held by the variant: f(), f( int64_t ), f( uint64_t ),
+         *  f( double ), f( bool ), f( const string& ), f( const variants& ),
+         *  f( const variant_object& ) or f( const blob& ).
+         *
+         *  Unlike visit( const visitor& ) the call is resolved at compile time and can be inlined.
+         *  @return what f returns, all overloads must return the same type
+         */
+        template<typename F, typename = typename std::enable_if<!std::is_base_of<visitor, typename std::decay<F>::type>::value>::type>
+        auto  visit( F&& f )const -> decltype( f() );
+
         type_id                     get_type()const;
 
         bool                        is_null()const;
@@ -270,16 +316,31 @@ namespace fc
          */
         string                      as_string()const;
 
-        /// @pre  get_type() == string_type
+        /**
+         * @pre  get_type() == string_type
+         * @note a short string stored inline is moved to the heap by the first call, which
+         *       changes the variant like the non-const getters do and must not race with
+         *       other threads using it.  string_value() and string_data()/string_size() read
+         *       it in place.
+         */
         const string&               get_string()const;
+
+        /// @throw if get_type() != string_type, short strings are copied into @a tmp
+        const string&               string_value( string& tmp )const;
+        /// @throw if get_type() != string_type, valid until the variant is modified
+        const char*                 string_data()const;
+        /// @throw if get_type() != string_type
+        size_t                      string_size()const;
                                     
         /// @throw if get_type() != array_type | null_type
+        /// @note clones the array if it is shared with another variant
         variants&                   get_array();
 
         /// @throw if get_type() != array_type 
         const variants&             get_array()const;
 
         /// @throw if get_type() != object_type | null_type
+        /// @note clones the object if it is shared with another variant
         variant_object&             get_object();
 
         /// @throw if get_type() != object_type 
@@ -341,6 +402,10 @@ namespace fc
         void    clear();
       private:
         void    init();
+        [[noreturn]] void throw_invalid_type()const;
+        /// @pre the variant holds a payload of type T
+        template<typename T>
+        const T& payload()const { return (*reinterpret_cast<detail::variant_payload<T>* const*>(this))->value; }
         double  _data;                ///< Alligned according to double requirements
         char    _type[sizeof(void*)]; ///< pad to void* size
    };
@@ -535,6 +600,41 @@ namespace fc
    }
 
 
+   inline variant::type_id variant::get_type()const
+   {
+      return (type_id)(reinterpret_cast<const uint8_t*>(this)[sizeof(*this)-1] & ~detail::inline_string_flag);
+   }
+
+   template<typename F, typename>
+   auto variant::visit( F&& f )const -> decltype( f() )
+   {
+      switch( get_type() )
+      {
+         case null_type:
+            return f();
+         case int64_type:
+            return f( *reinterpret_cast<const int64_t*>(this) );
+         case uint64_type:
+            return f( *reinterpret_cast<const uint64_t*>(this) );
+         case double_type:
+            return f( *reinterpret_cast<const double*>(this) );
+         case bool_type:
+            return f( *reinterpret_cast<const bool*>(this) );
+         case string_type:
+         {
+            string tmp;
+            return f( string_value( tmp ) );
+         }
+         case array_type:
+            return f( payload<variants>() );
+         case object_type:
+            return f( payload<variant_object>() );
+         case blob_type:
+            return f( payload<blob>() );
+      }
+      throw_invalid_type();
+   }
+
    template<typename T>
    variant::variant( const T& val )
    {
@@ -0,0 +1,86 @@
+#pragma once
+#include <fc/noncopyable.hpp>
+#include <cstddef>
+
+namespace fc
+{
+   class variant;
+   namespace detail { struct arena_blocks; }
+
+   /**
+    *  @brief Monotonic memory region for the nodes of request scoped variant trees.
+    *
+    *  The payloads that hold the strings, blobs, arrays and objects of the tree built by
+    *  json::from_string( text, arena ) or to_variant( value, result, arena ) are bump
+    *  allocated from the arena.  Releasing such a payload only runs its destructor, the
+    *  memory is returned in one step once the arena and every payload allocated from it
+    *  are gone.  Nothing else is allocated from an arena.
+    *
+    *  @code
+    *     fc::variant_arena arena;
+    *     fc::variant request = fc::json::from_string( text, arena );
+    *  @endcode
+    *
+    *  Copying a variant of the tree gives the copy payloads of its own on the heap, down to
+    *  the members and elements of the objects and arrays below it, so a copy kept in a cache
+    *  or an exception does not hold on to the arena.  A variant moved
+    *  out of the tree, or made while building it such as the ones of a parse error, keeps
+    *  the memory of the arena until it is destroyed.
+    */
+   class variant_arena : public noncopyable
+   {
+      public:
+         explicit variant_arena( size_t block_size = 64 * 1024 );
+         ~variant_arena();
+
+         /** @return memory aligned for any fundamental type */
+         void*  allocate( size_t size );
+
+         /** total number of bytes handed out by allocate() */
+         size_t allocated_bytes()const { return _allocated; }
+
+         /** the blocks of the arena, which outlive it while payloads are allocated from them */
+         detail::arena_blocks* blocks()const { return _blocks; }
+
+      private:
+         size_t                 _block_size;
+         char*                  _pos;
+         char*                  _end;
+         size_t                 _allocated;
+         size_t                 _allocations;
+         detail::arena_blocks*  _blocks;
+   };
+
+   namespace detail
+   {
+      /** gives back one allocation of an arena, from any thread */
+      void release_arena_allocation( arena_blocks* blocks );
+
+      /** the arena payloads of the variants built on this thread are allocated from */
+      variant_arena* current_variant_arena();
+
+      /**
+       *  Makes the payloads of the variants built on the calling thread come from an arena
+       *  for its lifetime.  Only the entry points that take an arena use it, around building
+       *  the one tree they return.
+       */
+      class variant_arena_scope : public noncopyable
+      {
+         public:
+            explicit variant_arena_scope( variant_arena& a );
+            ~variant_arena_scope();
+
+         private:
+            variant_arena* _previous;
+      };
+   }
+
+   /** to_variant( v, result ) with the payloads of @a result allocated from @a arena */
+   template<typename T>
+   void to_variant( const T& v, variant& result, variant_arena& arena )
+   {
+      detail::variant_arena_scope scope( arena );
+      to_variant( v, result );
+   }
+
+} // namespace fc
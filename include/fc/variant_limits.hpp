@@ -0,0 +1,159 @@
+#pragma once
+#include <fc/variant.hpp>
+#include <fc/noncopyable.hpp>
+#include <limits>
+
+namespace fc
+{
+   /**
+    *  @return an estimate of the bytes used by @a v and everything it refers to.  Payloads shared
+    *  by copies are counted for every copy, so the estimate is an upper bound for trees that share.
+    */
+   size_t estimated_size( const variant& v );
+   size_t estimated_size( const variant_object& o );
+   size_t estimated_size( const variants& a );
+
+   /**
+    *  @return the heap memory held by @a v itself: string and blob data, the slots of an array or
+    *  the entries and keys of an object, but not the values nested in it.  estimated_size() of a
+    *  tree is sizeof(variant) plus this for every node of the tree.
+    */
+   size_t estimated_node_size( const variant& v );
+
+   /**
+    *  @brief Upper bounds for the variant tree built by a single parse.
+    *
+    *  max_bytes is compared to the estimated_size() of the tree parsed so far, max_nodes counts
+    *  every value and max_depth bounds the nesting, where the root is at depth 0 like it is for
+    *  walk_variant().
+    */
+   struct parse_limits
+   {
+      size_t   max_bytes = std::numeric_limits<size_t>::max();
+      uint32_t max_nodes = std::numeric_limits<uint32_t>::max();
+      uint32_t max_depth = std::numeric_limits<uint32_t>::max();
+   };
+
+   /**
+    *  @brief Charges the values built by a parse against its parse_limits.
+    *
+    *  A budget is installed for the calling thread while it is alive, the parsers of json::from_string
+    *  and raw::unpack( variant ) look it up once per value, and check long strings and containers
+    *  while they grow, and throw an assert_exception as soon as a limit is exceeded, so a hostile
+    *  document is rejected before it is built completely.
+    *
+    *  @code
+    *     fc::parse_limits limits;
+    *     limits.max_bytes = 1024 * 1024;
+    *     fc::variant request = fc::json::from_string( text, limits );
+    *  @endcode
+    */
+   class parse_budget : public noncopyable
+   {
+      public:
+         explicit parse_budget( const parse_limits& limits );
+         ~parse_budget();
+
+         /** counts a completed value that holds @a bytes of heap memory, see estimated_node_size() */
+         void add_node( size_t bytes )
+         {
+            _bytes += bytes;
+            if( ++_nodes > _limits.max_nodes || _bytes > _limits.max_bytes )
+               exceeded();
+         }
+
+         /** checks that @a bytes more would fit, before a parser allocates them in one go */
+         void check_bytes( size_t bytes )const
+         {
+            if( _bytes > _limits.max_bytes || bytes > _limits.max_bytes - _bytes )
+               exceeded( bytes );
+         }
+
+         /** checks a value at @a depth, for parsers that track the nesting themselves */
+         void check_depth( uint32_t depth )const
+         {
+            if( depth > _limits.max_depth )
+               too_deep();
+         }
+
+         size_t   bytes()const { return _bytes; }
+         uint32_t nodes()const { return _nodes; }
+
+         /** forgets the values charged since bytes() and nodes() returned @a b and @a n, for parsers that retry */
+         void rewind( size_t b, uint32_t n ) { _bytes = b; _nodes = n; }
+
+         /** @return the budget of the calling thread, or nullptr */
+         static parse_budget* current();
+
+         /** one level of nesting, entered before the value at that level is parsed */
+         class level : public noncopyable
+         {
+            public:
+               explicit level( parse_budget& b ) : _budget(b)
+               {
+                  if( _budget._depth > _budget._limits.max_depth )
+                     _budget.exceeded();
+                  ++_budget._depth;
+               }
+               ~level() { --_budget._depth; }
+
+            private:
+               parse_budget& _budget;
+         };
+
+         /**
+          *  A string or container a parser fills a piece at a time.  What it holds so far is checked
+          *  against the budget of the thread every check_interval bytes, so that a single huge value
+          *  is rejected while it is read rather than once it is complete.
+          */
+         class growth
+         {
+            public:
+               enum { check_interval = 4096 };
+
+               growth() : _budget( current() ),
+                          _next_check( _budget ? size_t(check_interval) : std::numeric_limits<size_t>::max() ) {}
+
+               /** the value is about to hold @a bytes of heap memory */
+               void grow_to( size_t bytes )
+               {
+                  if( bytes >= _next_check )
+                  {
+                     _budget->check_bytes( bytes );
+                     _next_check = bytes + check_interval;
+                  }
+               }
+
+            private:
+               parse_budget*  _budget;
+               size_t         _next_check;
+         };
+
+      private:
+         [[noreturn]] void exceeded( size_t more = 0 )const;
+         [[noreturn]] void too_deep()const;
+
+         parse_limits   _limits;
+         size_t         _bytes;
+         uint32_t       _nodes = 0;
+         uint32_t       _depth = 0;
+         parse_budget*  _previous;
+   };
+
+   /**
+    *  Parses one value with @a parse and charges it to the budget of the calling thread, if there
+    *  is one.  The depth is checked before the value is parsed and its size once it is complete.
+    */
+   template<typename Parse>
+   variant budgeted_parse( Parse&& parse )
+   {
+      parse_budget* budget = parse_budget::current();
+      if( budget == nullptr )
+         return parse();
+      parse_budget::level level( *budget );
+      variant v = parse();
+      budget->add_node( estimated_node_size( v ) );
+      return v;
+   }
+
+} // namespace fc
@@ -2,11 +2,26 @@
 #include <fc/variant.hpp>
 #include <fc/shared_ptr.hpp>
 #include <fc/unique_ptr.hpp>
+#include <boost/container/small_vector.hpp>
 
 namespace fc
 {
    using std::map;
    class mutable_variant_object;
+
+   namespace detail { class key_index; }
+
+   /**
+    *  Marks an object key that points to text with static storage duration, such
+    *  as a string literal or a reflected member name.  Keys too long for the small
+    *  string buffer are interned: entries using them share one copy, so building
+    *  or copying those entries does not allocate.
+    */
+   struct static_key
+   {
+      explicit static_key( const char* k ) : str(k) {}
+      const char* str;
+   };
    
    /**
     *  @ingroup Serializable
@@ -16,8 +31,9 @@ namespace fc
     *  Keys are kept in the order they are inserted.
     *  This dictionary implements copy-on-write
     *
-    *  @note This class is not optimized for random-access on large
-    *        sets of key-value pairs.
+    *  @note Lookups scan the entries until the object grows large enough,
+    *        from then on a hash index is built on the first lookup and
+    *        shared by all copies made afterwards.
     */
    class variant_object
    {
@@ -28,6 +44,7 @@ namespace fc
       public:
          entry();
          entry( string k, variant v );
+         entry( static_key k, variant v );
          entry( entry&& e );
          entry( const entry& e);
          entry& operator=(const entry&);
@@ -40,8 +57,9 @@ namespace fc
          variant&       value();
              
       private:
-         string  _key;
-         variant _value;
+         string          _key;
+         const string*   _interned_key = nullptr; ///< used instead of _key when set
+         variant         _value;
       };
 
       typedef std::vector< entry >::const_iterator iterator;
@@ -97,6 +115,8 @@ namespace fc
 
    private:
       std::shared_ptr< std::vector< entry > > _key_value;
+      /// built lazily by find(), accessed with std::atomic_load/atomic_store
+      mutable std::shared_ptr< detail::key_index > _index;
       friend class mutable_variant_object;
    };
    /** @ingroup Serializable */
@@ -113,8 +133,12 @@ namespace fc
    *  Keys are kept in the order they are inserted.
    *  This dictionary implements copy-on-write
    *
-   *  @note This class is not optimized for random-access on large
-   *        sets of key-value pairs.
+   *  @note Like variant_object, large objects are indexed by key on the
+   *        first lookup and the index is kept up to date by appends.
+   *
+   *  @note The first inline_capacity entries are stored in the object itself, so
+   *        the small objects built for log messages and exceptions do not allocate
+   *        beyond their strings.
    */
    class mutable_variant_object
    {
@@ -122,8 +146,12 @@ namespace fc
       /** @brief a key/value pair */
       typedef variant_object::entry  entry;
 
-      typedef std::vector< entry >::iterator       iterator;
-      typedef std::vector< entry >::const_iterator const_iterator;
+      /** number of entries held without a heap allocation */
+      static const size_t inline_capacity = 4;
+      typedef boost::container::small_vector< entry, inline_capacity > entries;
+
+      typedef entries::iterator       iterator;
+      typedef entries::const_iterator const_iterator;
 
       /**
          * @name Immutable Interface
@@ -164,6 +192,7 @@ namespace fc
 
       /** replaces the value at \a key with \a var or insert's \a key if not found */
       mutable_variant_object& set( string key, variant var );
+      mutable_variant_object& set( static_key key, variant var );
       /** Appends \a key and \a var without checking for duplicates, designed to
          *  simplify construction of dictionaries using (key,val)(key2,val2) syntax 
          */
@@ -179,27 +208,61 @@ namespace fc
       *
       *  @return *this;
       */
-      mutable_variant_object& operator()( string key, variant var );
+      mutable_variant_object& operator()( string key, variant var ) &;
       template<typename T>
-      mutable_variant_object& operator()( string key, T&& var )
+      mutable_variant_object& operator()( string key, T&& var ) &
       {
          set(std::move(key), variant( fc::forward<T>(var) ) );
          return *this;
       }
+      template<typename T>
+      mutable_variant_object& operator()( static_key key, T&& var ) &
+      {
+         set( key, variant( fc::forward<T>(var) ) );
+         return *this;
+      }
       /**
        * Copy a variant_object into this mutable_variant_object.
        */
-      mutable_variant_object& operator()( const variant_object& vo );
+      mutable_variant_object& operator()( const variant_object& vo ) &;
       /**
        * Copy another mutable_variant_object into this mutable_variant_object.
        */
-      mutable_variant_object& operator()( const mutable_variant_object& mvo );
+      mutable_variant_object& operator()( const mutable_variant_object& mvo ) &;
+
+      /**
+       *  Chains on a temporary, as in <code>mutable_variant_object()( "a", a )( "b", b )</code>,
+       *  stay rvalues so the finished object is moved into the variant_object it is
+       *  passed as instead of being copied.
+       */
+      template<typename... Args>
+      mutable_variant_object&& operator()( Args&&... args ) &&
+      {
+         (*this)( fc::forward<Args>(args)... );
+         return std::move(*this);
+      }
+
+      /**
+       *  Appends \a key with a value built from \a var without checking for duplicates,
+       *  the value is moved or forwarded to its variant constructor and never copied.
+       */
+      template<typename T>
+      mutable_variant_object& emplace( string key, T&& var )
+      {
+         append( entry( std::move(key), variant( fc::forward<T>(var) ) ) );
+         return *this;
+      }
+      template<typename T>
+      mutable_variant_object& emplace( static_key key, T&& var )
+      {
+         append( entry( key, variant( fc::forward<T>(var) ) ) );
+         return *this;
+      }
       ///@}
 
 
       template<typename T>
       explicit mutable_variant_object( T&& v )
-      :_key_value( new std::vector<entry>() )
       {
           *this = variant(fc::forward<T>(v)).get_object();
       }
@@ -207,11 +270,10 @@ namespace fc
       mutable_variant_object();
 
       template<typename T>
-      mutable_variant_object( const map<string,T>& values )
-      :_key_value( new std::vector<entry>() ) {
-         _key_value->reserve( values.size() );
+      mutable_variant_object( const map<string,T>& values ) {
+         _key_value.reserve( values.size() );
          for( const auto& item : values ) {
-            _key_value->emplace_back( variant_object::entry( item.first, fc::variant(item.second) ) );
+            _key_value.emplace_back( variant_object::entry( item.first, fc::variant(item.second) ) );
          }
       }
 
@@ -219,7 +281,6 @@ namespace fc
       mutable_variant_object( string key, variant val );
       template<typename T>
       mutable_variant_object( string key, T&& val )
-      :_key_value( new std::vector<entry>() )
       {
          set( std::move(key), variant(forward<T>(val)) );
       }
@@ -234,7 +295,12 @@ namespace fc
 
 
    private:
-      std::unique_ptr< std::vector< entry > > _key_value;
+      void append( entry&& e );
+
+      /// mutable because the const accessors have always handed out mutable iterators
+      mutable entries                              _key_value;
+      /// built lazily by find(), accessed with std::atomic_load/atomic_store
+      mutable std::shared_ptr< detail::key_index > _index;
       friend class variant_object;
    };
    /** @ingroup Serializable */
@@ -257,4 +323,28 @@ namespace fc
          vo[itr->key()] = itr->value().as<T>();
    }
 
+   /**
+    *  Calls f( value, depth ) for @a v and then for every value nested in it, depth first and in
+    *  order.  Array elements and object member values are one level deeper than their parent,
+    *  use value.visit( ... ) within @a f to dispatch on their type.
+    */
+   template<typename F>
+   void walk_variant( const variant& v, F&& f, uint32_t depth = 0 )
+   {
+      f( v, depth );
+      switch( v.get_type() )
+      {
+         case variant::array_type:
+            for( const auto& item : v.get_array() )
+               walk_variant( item, f, depth + 1 );
+            break;
+         case variant::object_type:
+            for( const auto& member : v.get_object() )
+               walk_variant( member.value(), f, depth + 1 );
+            break;
+         default:
+            break;
+      }
+   }
+
 } // namespace fc
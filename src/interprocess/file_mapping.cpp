@@ -38,4 +38,9 @@ namespace fc {
   {
     return my->get_size();
   }
+
+  bool mapped_region::advise_sequential()
+  {
+    return my->advise( boost::interprocess::mapped_region::advice_sequential );
+  }
 }
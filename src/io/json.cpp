@@ -1,14 +1,20 @@
 #include <fc/io/json.hpp>
+#include <fc/variant_arena.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/io/iostream.hpp>
 #include <fc/io/buffered_iostream.hpp>
 #include <fc/io/fstream.hpp>
 #include <fc/io/sstream.hpp>
+#include <fc/crypto/base64.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/filesystem.hpp>
 #include <fc/log/logger.hpp>
 //#include <utfcpp/utf8.h>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <limits>
+#include <stdio.h>
 
 #include <boost/filesystem/fstream.hpp>
 
@@ -16,6 +22,7 @@ namespace fc
 {
     // forward declarations of provided functions
     template<typename T, json::parse_type parser_type> variant variant_from_stream( T& in );
+    template<typename T, json::parse_type parser_type> variant value_from_stream( T& in );
     template<typename T> char parseEscape( T& in );
     template<typename T> fc::string stringFromStream( T& in );
     template<typename T> bool skip_white_space( T& in );
@@ -24,14 +31,13 @@ namespace fc
     template<typename T, json::parse_type parser_type> variants arrayFromStream( T& in );
     template<typename T, json::parse_type parser_type> variant number_from_stream( T& in );
     template<typename T> variant token_from_stream( T& in );
-    void escape_string( const string& str, ostream& os );
-    template<typename T> void to_stream( T& os, const variants& a, json::output_formatting format );
-    template<typename T> void to_stream( T& os, const variant_object& o, json::output_formatting format );
-    template<typename T> void to_stream( T& os, const variant& v, json::output_formatting format );
-    fc::string pretty_print( const fc::string& v, uint8_t indent );
 }
 
+#include <fc/io/json_number.hpp>
 #include <fc/io/json_relaxed.hpp>
+#include <fc/io/json_structural.hpp>
+#include <fc/io/json_sax.hpp>
+#include <fc/io/json_validator.hpp>
 
 namespace fc
 {
@@ -89,6 +95,8 @@ namespace fc
    fc::string stringFromStream( T& in )
    {
       fc::stringstream token;
+      parse_budget::growth growth;
+      size_t length = 0;
       try
       {
          char c = in.peek();
@@ -100,7 +108,7 @@ namespace fc
          in.get();
          while( true )
          {
-
+            growth.grow_to( ++length );
             switch( c = in.peek() )
             {
                case '\\':
@@ -171,6 +179,8 @@ namespace fc
    variant_object objectFromStream( T& in )
    {
       mutable_variant_object obj;
+      parse_budget::growth growth;
+      size_t key_bytes = 0;
       try
       {
          char c = in.peek();
@@ -198,7 +208,9 @@ namespace fc
             in.get();
             auto val = variant_from_stream<T, parser_type>( in );
 
+            key_bytes += key.size();
             obj(std::move(key),std::move(val));
+            growth.grow_to( obj.size() * sizeof(variant_object::entry) + key_bytes );
             skip_white_space(in);
          }
          if( in.peek() == '}' )
@@ -222,6 +234,7 @@ namespace fc
    variants arrayFromStream( T& in )
    {
       variants ar;
+      parse_budget::growth growth;
       try
       {
         if( in.peek() != '[' )
@@ -238,6 +251,7 @@ namespace fc
            }
            if( skip_white_space(in) ) continue;
            ar.push_back( variant_from_stream<T, parser_type>(in) );
+           growth.grow_to( ar.capacity() * sizeof(variant) );
            skip_white_space(in);
         }
         if( in.peek() != ']' )
@@ -253,14 +267,15 @@ namespace fc
    template<typename T, json::parse_type parser_type>
    variant number_from_stream( T& in )
    {
-      fc::stringstream ss;
+      // numbers are short, this stays in the small string buffer
+      fc::string str;
 
       bool  dot = false;
       bool  neg = false;
       if( in.peek() == '-')
       {
         neg = true;
-        ss.put( in.get() );
+        str.push_back( in.get() );
       }
       bool done = false;
 
@@ -286,12 +301,12 @@ namespace fc
               case '7':
               case '8':
               case '9':
-                 ss.put( in.get() );
+                 str.push_back( in.get() );
                  break;
               default:
                  if( isalnum( c ) )
                  {
-                    return ss.str() + stringFromToken( in );
+                    return str + stringFromToken( in );
                  }
                 done = true;
                 break;
@@ -304,14 +319,14 @@ namespace fc
       catch (const std::ios_base::failure&)
       {
       }
-      fc::string str = ss.str();
       if (str == "-." || str == ".") // check the obviously wrong things we could have encountered
         FC_THROW_EXCEPTION(parse_error_exception, "Can't parse token \"${token}\" as a JSON numeric constant", ("token", str));
+      const char* end = str.data() + str.size();
       if( dot )
-        return parser_type == json::legacy_parser_with_string_doubles ? variant(str) : variant(to_double(str));
+        return parser_type == json::legacy_parser_with_string_doubles ? variant(str) : variant(json_number::to_double(str.data(), end));
       if( neg )
-        return to_int64(str);
-      return to_uint64(str);
+        return json_number::to_int64(str.data(), end);
+      return json_number::to_uint64(str.data(), end);
    }
    template<typename T>
    variant token_from_stream( T& in )
@@ -385,8 +400,15 @@ namespace fc
    }
 
 
+   /** parses one value and charges it to the parse_budget of the thread, if any */
    template<typename T, json::parse_type parser_type>
    variant variant_from_stream( T& in )
+   {
+      return budgeted_parse( [&]() { return value_from_stream<T, parser_type>( in ); } );
+   }
+
+   template<typename T, json::parse_type parser_type>
+   variant value_from_stream( T& in )
    {
       skip_white_space(in);
       variant var;
@@ -460,6 +482,14 @@ namespace fc
    { try {
       check_string_depth( utf8_str );
 
+      if( ptype == structural_parser )
+      {
+         variant result;
+         if( json_structural::parse( utf8_str.data(), utf8_str.size(), result ) )
+            return result;
+         ptype = legacy_parser;
+      }
+
       fc::stringstream in( utf8_str );
       //in.exceptions( std::ifstream::eofbit );
       switch( ptype )
@@ -477,6 +507,18 @@ namespace fc
       }
    } FC_RETHROW_EXCEPTIONS( warn, "", ("str",utf8_str) ) }
 
+   variant json::from_string( const std::string& utf8_str, const parse_limits& limits, parse_type ptype )
+   {
+      parse_budget budget( limits );
+      return from_string( utf8_str, ptype );
+   }
+
+   variant json::from_string( const std::string& utf8_str, variant_arena& arena, parse_type ptype )
+   {
+      detail::variant_arena_scope scope( arena );
+      return from_string( utf8_str, ptype );
+   }
+
    variants json::variants_from_string( const std::string& utf8_str, parse_type ptype )
    { try {
       check_string_depth( utf8_str );
@@ -505,305 +547,320 @@ namespace fc
    }
    */
 
+   void json_buffer::write_int( int64_t i, bool quoted )
+   {
+      begin_value();
+      if( quoted )
+         _text.push_back( '"' );
+      if( i < 0 )
+      {
+         _text.push_back( '-' );
+         write_digits( 0 - uint64_t(i) );
+      }
+      else
+         write_digits( uint64_t(i) );
+      if( quoted )
+         _text.push_back( '"' );
+   }
+
+   void json_buffer::write_uint( uint64_t i, bool quoted )
+   {
+      begin_value();
+      if( quoted )
+         _text.push_back( '"' );
+      write_digits( i );
+      if( quoted )
+         _text.push_back( '"' );
+   }
+
+   void json_buffer::write_digits( uint64_t i )
+   {
+      char digits[20];
+      char* p = digits + sizeof(digits);
+      do
+      {
+         *--p = char( '0' + i % 10 );
+         i /= 10;
+      } while( i );
+      _text.append( p, digits + sizeof(digits) );
+   }
+
+   void json_buffer::write_double( double d, bool quoted )
+   {
+      // the format of fc::to_string( double ), which is std::fixed with digits10 + 2 digits
+      char digits[400];
+      const int len = snprintf( digits, sizeof(digits), "%.*f", std::numeric_limits<double>::digits10 + 2, d );
+      begin_value();
+      if( quoted )
+         _text.push_back( '"' );
+      _text.append( digits, len );
+      if( quoted )
+         _text.push_back( '"' );
+   }
+
    /**
     *  Convert '\t', '\a', '\n', '\\' and '"'  to "\t\a\n\\\""
     *
-    *  All other characters are printed as UTF8.
+    *  All other characters are printed as UTF8, the runs between escapes are found with
+    *  json_structural::find_escape() and copied as a whole.
     */
-   void escape_string( const string& str, ostream& os )
+   void json_buffer::write_string( const char* str, size_t len )
    {
-      os << '"';
-      for( auto itr = str.begin(); itr != str.end(); ++itr )
+      static const char hex[] = "0123456789abcdef";
+      begin_value();
+      _text.reserve( _text.size() + len + 2 );
+      _text.push_back( '"' );
+      const char* end = str + len;
+      const char* run = str;
+      while( true )
       {
-         switch( *itr )
+         const char* itr = json_structural::find_escape( run, end );
+         if( itr != run )
+            _text.append( run, itr );
+         if( itr == end )
+            break;
+
+         // escapes that follow each other are appended together
+         char escaped[96];
+         char* out = escaped;
+         do
          {
-            case '\b':        // \x08
-               os << "\\b";
-               break;
-            case '\f':        // \x0c
-               os << "\\f";
-               break;
-            case '\n':        // \x0a
-               os << "\\n";
-               break;
-            case '\r':        // \x0d
-               os << "\\r";
-               break;
-            case '\t':        // \x09
-               os << "\\t";
-               break;
-            case '\\':
-               os << "\\\\";
-               break;
-            case '\"':
-               os << "\\\"";
-               break;
-            case '\x00': os << "\\u0000"; break;
-            case '\x01': os << "\\u0001"; break;
-            case '\x02': os << "\\u0002"; break;
-            case '\x03': os << "\\u0003"; break;
-            case '\x04': os << "\\u0004"; break;
-            case '\x05': os << "\\u0005"; break;
-            case '\x06': os << "\\u0006"; break;
-            case '\x07': os << "\\u0007"; break; // \a is not valid JSON
-         // case '\x08': os << "\\u0008"; break; // \b
-         // case '\x09': os << "\\u0009"; break; // \t
-         // case '\x0a': os << "\\u000a"; break; // \n
-            case '\x0b': os << "\\u000b"; break;
-         // case '\x0c': os << "\\u000c"; break; // \f
-         // case '\x0d': os << "\\u000d"; break; // \r
-            case '\x0e': os << "\\u000e"; break;
-            case '\x0f': os << "\\u000f"; break;
-
-            case '\x10': os << "\\u0010"; break;
-            case '\x11': os << "\\u0011"; break;
-            case '\x12': os << "\\u0012"; break;
-            case '\x13': os << "\\u0013"; break;
-            case '\x14': os << "\\u0014"; break;
-            case '\x15': os << "\\u0015"; break;
-            case '\x16': os << "\\u0016"; break;
-            case '\x17': os << "\\u0017"; break;
-            case '\x18': os << "\\u0018"; break;
-            case '\x19': os << "\\u0019"; break;
-            case '\x1a': os << "\\u001a"; break;
-            case '\x1b': os << "\\u001b"; break;
-            case '\x1c': os << "\\u001c"; break;
-            case '\x1d': os << "\\u001d"; break;
-            case '\x1e': os << "\\u001e"; break;
-            case '\x1f': os << "\\u001f"; break;
+            const unsigned char c = *itr++;
+            *out++ = '\\';
+            switch( c )
+            {
+               case '\b': *out++ = 'b'; break;
+               case '\f': *out++ = 'f'; break;
+               case '\n': *out++ = 'n'; break;
+               case '\r': *out++ = 'r'; break;
+               case '\t': *out++ = 't'; break;
+               case '\\': *out++ = '\\'; break;
+               case '"':  *out++ = '"'; break;
+               default: // \a and the other control characters are not valid JSON
+                  *out++ = 'u';
+                  *out++ = '0';
+                  *out++ = '0';
+                  *out++ = hex[c >> 4];
+                  *out++ = hex[c & 0xf];
+            }
+         } while( itr != end && out + 6 <= escaped + sizeof(escaped) &&
+                  ( (unsigned char)*itr < 0x20 || *itr == '"' || *itr == '\\' ) );
+         _text.append( escaped, out );
+         run = itr;
+      }
+      _text.push_back( '"' );
+   }
 
-            default:
-               os << *itr;
-               //toUTF8( *itr, os );
-         }
+   void json_buffer::flush()
+   {
+      if( _stream && !_text.empty() )
+      {
+         _stream->write( _text.data(), _text.size() );
+         _text.clear();
       }
-      os << '"';
    }
+
    ostream& json::to_stream( ostream& out, const fc::string& str )
    {
-        escape_string( str, out );
+        json_buffer buffer( out );
+        buffer.write_string( str.data(), str.size() );
+        buffer.flush();
         return out;
    }
 
-   template<typename T>
-   void to_stream( T& os, const variants& a, json::output_formatting format )
+   void json_writer::write( const variants& a )
    {
-      os << '[';
+      _out.open( '[' );
       auto itr = a.begin();
 
       while( itr != a.end() )
       {
-         to_stream( os, *itr, format );
+         write( *itr );
          ++itr;
          if( itr != a.end() )
-            os << ',';
+            _out.separator();
+         _out.maybe_flush();
       }
-      os << ']';
+      _out.close( ']' );
    }
-   template<typename T>
-   void to_stream( T& os, const variant_object& o, json::output_formatting format )
+
+   void json_writer::write( const variant_object& o )
    {
-       os << '{';
+       _out.open( '{' );
        auto itr = o.begin();
 
        while( itr != o.end() )
        {
-          escape_string( itr->key(), os );
-          os << ':';
-          to_stream( os, itr->value(), format );
+          _out.write_string( itr->key().data(), itr->key().size() );
+          _out.key_separator();
+          write( itr->value() );
           ++itr;
           if( itr != o.end() )
-             os << ',';
+             _out.separator();
+          _out.maybe_flush();
        }
-       os << '}';
+       _out.close( '}' );
    }
 
-   template<typename T>
-   void to_stream( T& os, const variant& v, json::output_formatting format )
+   /** writes the value of a variant, used with variant::visit( F&& ) */
+   class variant_json_writer
    {
-      switch( v.get_type() )
-      {
-         case variant::null_type:
-              os << "null";
-              return;
-         case variant::int64_type:
+      public:
+         variant_json_writer( json_writer& writer, json_buffer& os, json::output_formatting format )
+         :writer(writer),os(os),format(format){}
+
+         void operator()()const
          {
-              int64_t i = v.as_int64();
-              if( format == json::stringify_large_ints_and_doubles &&
-                  i > 0xffffffff )
-                 os << '"'<<v.as_string()<<'"';
-              else
-                 os << i;
-
-              return;
+            os.write_null();
          }
-         case variant::uint64_type:
+         void operator()( int64_t i )const
          {
-              uint64_t i = v.as_uint64();
-              if( format == json::stringify_large_ints_and_doubles &&
-                  i > 0xffffffff )
-                 os << '"'<<v.as_string()<<'"';
-              else
-                 os << i;
-
-              return;
+            os.write_int( i, format == json::stringify_large_ints_and_doubles && i > 0xffffffff );
          }
-         case variant::double_type:
-              if (format == json::stringify_large_ints_and_doubles)
-                 os << '"'<<v.as_string()<<'"';
-              else
-                 os << v.as_string();
-              return;
-         case variant::bool_type:
-              os << v.as_string();
-              return;
-         case variant::string_type:
-              escape_string( v.get_string(), os );
-              return;
-         case variant::blob_type:
-              escape_string( v.as_string(), os );
-              return;
-         case variant::array_type:
-           {
-              const variants&  a = v.get_array();
-              to_stream( os, a, format );
-              return;
-           }
-         case variant::object_type:
-           {
-              const variant_object& o =  v.get_object();
-              to_stream(os, o, format );
-              return;
-           }
-      }
+         void operator()( uint64_t i )const
+         {
+            os.write_uint( i, format == json::stringify_large_ints_and_doubles && i > 0xffffffff );
+         }
+         void operator()( double d )const
+         {
+            os.write_double( d, format == json::stringify_large_ints_and_doubles );
+         }
+         void operator()( bool b )const
+         {
+            os.write_bool( b );
+         }
+         void operator()( const string& s )const
+         {
+            os.write_string( s.data(), s.size() );
+         }
+         void operator()( const blob& b )const
+         {
+            // the text of variant::as_string() for blobs
+            const string base64 = base64_encode( b.data.data(), b.data.size() ) + "=";
+            os.write_string( base64.data(), base64.size() );
+         }
+         void operator()( const variants& a )const
+         {
+            writer.write( a );
+         }
+         void operator()( const variant_object& o )const
+         {
+            writer.write( o );
+         }
+
+      private:
+         json_writer&              writer;
+         json_buffer&              os;
+         json::output_formatting   format;
+   };
+
+   void json_writer::write( const variant& v )
+   {
+      v.visit( variant_json_writer( *this, _out, _format ) );
    }
 
    fc::string   json::to_string( const variant& v, output_formatting format /* = stringify_large_ints_and_doubles */ )
    {
-      fc::stringstream ss;
-      fc::to_stream( ss, v, format );
-      return ss.str();
-   }
-
-
-    fc::string pretty_print( const fc::string& v, uint8_t indent ) {
-      int level = 0;
-      fc::stringstream ss;
-      bool first = false;
-      bool quote = false;
-      bool escape = false;
-      for( uint32_t i = 0; i < v.size(); ++i ) {
-         switch( v[i] ) {
-            case '\\':
-              if( !escape ) {
-                if( quote )
-                  escape = true;
-              } else { escape = false; }
-              ss<<v[i];
-              break;
-            case ':':
-              if( !quote ) {
-                ss<<": ";
-              } else {
-                ss<<':';
-              }
-              break;
-            case '"':
-              if( first ) {
-                 ss<<'\n';
-                 for( int i = 0; i < level*indent; ++i ) ss<<' ';
-                 first = false;
-              }
-              if( !escape ) {
-                quote = !quote;
-              }
-              escape = false;
-              ss<<'"';
-              break;
-            case '{':
-            case '[':
-              ss<<v[i];
-              if( !quote ) {
-                ++level;
-                first = true;
-              }else {
-                escape = false;
-              }
-              break;
-            case '}':
-            case ']':
-              if( !quote ) {
-                if( v[i-1] != '[' && v[i-1] != '{' ) {
-                  ss<<'\n';
-                }
-                --level;
-                if( !first ) {
-                  for( int i = 0; i < level*indent; ++i ) ss<<' ';
-                }
-                first = false;
-                ss<<v[i];
-                break;
-              } else {
-                escape = false;
-                ss<<v[i];
-              }
-              break;
-            case ',':
-              if( !quote ) {
-                ss<<',';
-                first = true;
-              } else {
-                escape = false;
-                ss<<',';
-              }
-              break;
-            case 'n':
-              //If we're in quotes and see a \n, just print it literally but unset the escape flag.
-              if( quote && escape )
-                escape = false;
-              //No break; fall through to default case
-            default:
-              if( first ) {
-                 ss<<'\n';
-                 for( int i = 0; i < level*indent; ++i ) ss<<' ';
-                 first = false;
-              }
-              ss << v[i];
-         }
-      }
-      return ss.str();
-    }
-
+      fc::string out;
+      json_buffer buffer( out );
+      json_writer( buffer, format ).write( v );
+      return out;
+   }
 
 
    fc::string json::to_pretty_string( const variant& v, output_formatting format /* = stringify_large_ints_and_doubles */ )
    {
-	   return pretty_print(to_string(v, format), 2);
+      fc::string out;
+      json_buffer buffer( out, 2 );
+      json_writer( buffer, format ).write( v );
+      return out;
    }
 
    void json::save_to_file( const variant& v, const fc::path& fi, bool pretty, output_formatting format /* = stringify_large_ints_and_doubles */ )
    {
-      if( pretty )
-      {
-        auto str = json::to_pretty_string( v, format );
-        fc::ofstream o(fi);
-        o.write( str.c_str(), str.size() );
-      }
-      else
+      fc::ofstream o(fi);
+      json_buffer buffer( o, pretty ? 2 : 0 );
+      json_writer( buffer, format ).write( v );
+      buffer.flush();
+   }
+   /** reads a buffer with the peek() and get() of the parsers, throwing eof_exception at its end like fc::stringstream */
+   class buffer_istream
+   {
+      public:
+         buffer_istream( const char* data, size_t size ):_p(data),_end(data + size){}
+
+         char peek()const
+         {
+            if( _p == _end )
+               FC_THROW_EXCEPTION( eof_exception, "buffer_istream" );
+            return *_p;
+         }
+
+         char get()
+         {
+            const char c = peek();
+            ++_p;
+            return c;
+         }
+
+      private:
+         const char* _p;
+         const char* _end;
+   };
+
+   static variant variant_from_buffer( const char* data, size_t size, json::parse_type ptype )
+   {
+      switch( ptype )
       {
-       fc::ofstream o(fi);
-       fc::to_stream( o, v, format );
+          case json::structural_parser:
+          {
+              variant result;
+              if( json_structural::parse( data, size, result ) )
+                 return result;
+              // the legacy parser reports errors and reads the lenient forms
+          }
+          // fall through
+          case json::legacy_parser:
+          {
+              buffer_istream in( data, size );
+              return variant_from_stream<buffer_istream, json::legacy_parser>( in );
+          }
+          case json::legacy_parser_with_string_doubles:
+          {
+              buffer_istream in( data, size );
+              return variant_from_stream<buffer_istream, json::legacy_parser_with_string_doubles>( in );
+          }
+          case json::strict_parser:
+          {
+              buffer_istream in( data, size );
+              return json_relaxed::variant_from_stream<buffer_istream, true>( in );
+          }
+          case json::relaxed_parser:
+          {
+              buffer_istream in( data, size );
+              return json_relaxed::variant_from_stream<buffer_istream, false>( in );
+          }
+          default:
+              FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", ptype) );
       }
    }
+
    variant json::from_file( const fc::path& p, parse_type ptype )
    {
-      //auto tmp = std::make_shared<fc::ifstream>( p, ifstream::binary );
-      //auto tmp = std::make_shared<std::ifstream>( p.generic_string().c_str(), std::ios::binary );
-      //buffered_istream bi( tmp );
+      if( fc::exists( p ) && fc::file_size( p ) > 0 )
+      {
+         file_mapping fm( p.generic_string().c_str(), read_only );
+         mapped_region region( fm, read_only );
+         region.advise_sequential();
+         return variant_from_buffer( static_cast<const char*>( region.get_address() ), region.get_size(), ptype );
+      }
+
+      // empty and missing files cannot be mapped, the stream reports them like it always has
       boost::filesystem::ifstream bi( p, std::ios::binary );
       switch( ptype )
       {
           case legacy_parser:
+          case structural_parser:
               return variant_from_stream<boost::filesystem::ifstream, legacy_parser>( bi );
           case legacy_parser_with_string_doubles:
               return variant_from_stream<boost::filesystem::ifstream, legacy_parser_with_string_doubles>( bi );
@@ -820,6 +877,7 @@ namespace fc
       switch( ptype )
       {
           case legacy_parser:
+          case structural_parser:
               return variant_from_stream<fc::buffered_istream, legacy_parser>( in );
           case legacy_parser_with_string_doubles:
               return variant_from_stream<fc::buffered_istream, legacy_parser_with_string_doubles>( in );
@@ -832,29 +890,127 @@ namespace fc
       }
    }
 
-   ostream& json::to_stream( ostream& out, const variant& v, output_formatting format /* = stringify_large_ints_and_doubles */ )
+   template<typename T>
+   static ostream& write_to_stream( ostream& out, const T& v, json::output_formatting format )
    {
-      fc::to_stream( out, v, format );
+      json_buffer buffer( out );
+      json_writer( buffer, format ).write( v );
+      buffer.flush();
       return out;
    }
+
+   ostream& json::to_stream( ostream& out, const variant& v, output_formatting format /* = stringify_large_ints_and_doubles */ )
+   {
+      return write_to_stream( out, v, format );
+   }
    ostream& json::to_stream( ostream& out, const variants& v, output_formatting format /* = stringify_large_ints_and_doubles */ )
    {
-      fc::to_stream( out, v, format );
-      return out;
+      return write_to_stream( out, v, format );
    }
    ostream& json::to_stream( ostream& out, const variant_object& v, output_formatting format /* = stringify_large_ints_and_doubles */ )
    {
-      fc::to_stream( out, v, format );
-      return out;
+      return write_to_stream( out, v, format );
+   }
+
+   // used by json_reader
+   template bool       skip_white_space( fc::stringstream& in );
+   template bool       skip_white_space( buffered_istream& in );
+   template fc::string stringFromStream( fc::stringstream& in );
+   template fc::string stringFromStream( buffered_istream& in );
+   template variant    variant_from_stream<fc::stringstream, json::legacy_parser>( fc::stringstream& in );
+   template variant    variant_from_stream<fc::stringstream, json::legacy_parser_with_string_doubles>( fc::stringstream& in );
+   template variant    variant_from_stream<buffered_istream, json::legacy_parser>( buffered_istream& in );
+   template variant    variant_from_stream<buffered_istream, json::legacy_parser_with_string_doubles>( buffered_istream& in );
+
+   namespace
+   {
+      /** builds nothing, it only notes that there is a value and bounds the nesting */
+      class validating_handler : public json_sax_handler
+      {
+         public:
+            virtual void on_null() override                  { _value = true; }
+            virtual void on_bool( bool ) override            { _value = true; }
+            virtual void on_int64( int64_t ) override        { _value = true; }
+            virtual void on_uint64( uint64_t ) override      { _value = true; }
+            virtual void on_double( double ) override        { _value = true; }
+            virtual void on_string( string&& ) override      { _value = true; }
+            virtual void on_start_object() override          { open(); }
+            virtual void on_key( string&& ) override         {}
+            virtual void on_end_object() override            { --_depth; }
+            virtual void on_start_array() override           { open(); }
+            virtual void on_end_array() override             { --_depth; }
+
+            bool has_value()const { return _value; }
+
+         private:
+            void open()
+            {
+               _value = true;
+               if( ++_depth > json_validator::max_depth )
+                  FC_THROW_EXCEPTION( parse_error_exception, "object graph too deep", ("max_depth", json_validator::max_depth) );
+            }
+
+            uint32_t _depth = 0;
+            bool     _value = false;
+      };
+
+      /**
+       *  Runs a json_sax_parser that only checks the text of the tokens over the first value, the
+       *  legacy parser reads no more than that.
+       */
+      bool validate_legacy( const char* data, size_t size, json::parse_type ptype, size_t& error_offset )
+      {
+         validating_handler handler;
+         json_sax_parser parser( handler, ptype, true );
+         try
+         {
+            const size_t read = parser.feed_value( data, size );
+            if( read < size )
+            {
+               error_offset = read;
+               return false;
+            }
+            parser.finish();
+         }
+         catch( const fc::exception& )
+         {
+            error_offset = parser.offset();
+            return false;
+         }
+         error_offset = size;
+         return handler.has_value();
+      }
+
+      bool validate( const char* data, size_t size, json::parse_type ptype, size_t& error_offset )
+      {
+         switch( ptype )
+         {
+             case json::legacy_parser:
+             case json::legacy_parser_with_string_doubles:
+             case json::structural_parser:
+                 return validate_legacy( data, size, ptype, error_offset );
+             case json::strict_parser:
+                 return json_validator::validate_relaxed( data, size, true, error_offset );
+             case json::relaxed_parser:
+                 return json_validator::validate_relaxed( data, size, false, error_offset );
+             default:
+                 FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", ptype) );
+         }
+      }
    }
 
    bool json::is_valid( const std::string& utf8_str, parse_type ptype )
    {
+      size_t error_offset = 0;
+      if( validate( utf8_str.data(), utf8_str.size(), ptype, error_offset ) )
+         return true;
+      // the parser throws the exception that explains the error, or returns false for trailing characters
       if( utf8_str.size() == 0 ) return false;
       fc::stringstream in( utf8_str );
       switch( ptype )
       {
           case legacy_parser:
+          case structural_parser:
               variant_from_stream<fc::stringstream, legacy_parser>( in );
               break;
           case legacy_parser_with_string_doubles:
@@ -873,4 +1029,9 @@ namespace fc
       return false;
    }
 
+   bool json::is_valid( const std::string& utf8_str, size_t& error_offset, parse_type ptype )
+   {
+      return validate( utf8_str.data(), utf8_str.size(), ptype, error_offset );
+   }
+
 } // fc
@@ -0,0 +1,326 @@
+#include <fc/io/json_extractor.hpp>
+#include <fc/exception/exception.hpp>
+#include <string.h>
+
+namespace fc
+{
+   namespace
+   {
+      inline bool is_white_space( char c ) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+      /** what ends a number or a word */
+      inline bool is_delimiter( char c ) { return is_white_space( c ) || c == ',' || c == ']' || c == '}'; }
+
+      /** the characters skip_container() has to look at */
+      struct structural_table
+      {
+         bool is[256] = {};
+         structural_table() { is['"'] = is['['] = is[']'] = is['{'] = is['}'] = true; }
+      };
+      const structural_table structural;
+
+      /** the path step @a key as an array index */
+      uint32_t to_index( const string& key )
+      {
+         if( key.empty() || key.size() > 9 )
+            return UINT32_MAX;
+         uint32_t index = 0;
+         for( const char c : key )
+         {
+            if( c < '0' || c > '9' )
+               return UINT32_MAX;
+            index = index * 10 + ( c - '0' );
+         }
+         return index;
+      }
+
+      /** whether the quoted string [@a begin, @a end) reads as @a key, with the escapes of the legacy parser */
+      bool key_equals( const char* begin, const char* end, bool escaped, const string& key )
+      {
+         if( !escaped )
+            return size_t( end - begin ) == key.size() && memcmp( begin, key.data(), key.size() ) == 0;
+
+         auto k = key.begin();
+         for( const char* p = begin; p != end; ++p, ++k )
+         {
+            char c = *p;
+            if( c == '\\' )
+            {
+               switch( *++p )
+               {
+                  case 't': c = '\t'; break;
+                  case 'n': c = '\n'; break;
+                  case 'r': c = '\r'; break;
+                  default:  c = *p;
+               }
+            }
+            if( k == key.end() || *k != c )
+               return false;
+         }
+         return k == key.end();
+      }
+   }
+
+   /**
+    *  Walks a document along the paths of a json_extractor.  The paths that lead through a value
+    *  are a bit each in a mask, so the walk only recurses as deep as the longest path.
+    */
+   class json_scanner
+   {
+      public:
+         json_scanner( const json_extractor& extractor, const char* data, size_t size, std::vector<json_slice>& out )
+         :_paths( extractor._paths ), _p( data ), _end( data + size ), _out( out ) {}
+
+         /** the value at the current position, at step @a depth of the @a active paths */
+         void value( uint64_t active, size_t depth )
+         {
+            skip_white_space();
+            const char* start = _p;
+
+            uint64_t found = 0;
+            uint64_t deeper = 0;
+            for( uint64_t m = active; m; m &= m - 1 )
+            {
+               const uint64_t bit = m & -m;
+               if( _paths[ index_of( bit ) ].size() == depth )
+                  found |= bit;
+               else
+                  deeper |= bit;
+            }
+
+            const char c = peek();
+            if( deeper && c == '{' )
+               object( deeper, depth );
+            else if( deeper && c == '[' )
+               array( deeper, depth );
+            else
+               skip_value();
+
+            for( ; found; found &= found - 1 )
+            {
+               json_slice& slice = _out[ index_of( found & -found ) ];
+               slice.data = start;
+               slice.size = _p - start;
+            }
+         }
+
+      private:
+         static size_t index_of( uint64_t bit ) { return __builtin_ctzll( bit ); }
+
+         char peek()const
+         {
+            if( _p == _end )
+               FC_THROW_EXCEPTION( parse_error_exception, "Unexpected EOF" );
+            return *_p;
+         }
+
+         void skip_white_space()
+         {
+            while( _p != _end && is_white_space( *_p ) )
+               ++_p;
+         }
+
+         /** the paths in @a active that leave the current value by @a key or @a index */
+         uint64_t match( uint64_t active, size_t depth, const char* key, const char* key_end, bool escaped, uint32_t index )
+         {
+            uint64_t matched = 0;
+            for( ; active; active &= active - 1 )
+            {
+               const uint64_t bit = active & -active;
+               const size_t i = index_of( bit );
+               const json_extractor::step& s = _paths[i][depth];
+               if( key ? key_equals( key, key_end, escaped, s.key ) : s.index == index )
+                  matched |= bit;
+            }
+            return matched;
+         }
+
+         void object( uint64_t active, size_t depth )
+         {
+            ++_p;
+            // parsed objects keep duplicate keys and find the first one, so a path takes the first key only
+            uint64_t taken = 0;
+            while( true )
+            {
+               skip_white_space();
+               const char c = peek();
+               if( c == '}' )
+               {
+                  ++_p;
+                  return;
+               }
+               if( c == ',' )
+               {
+                  ++_p;
+                  continue;
+               }
+               if( c != '"' )
+                  FC_THROW_EXCEPTION( parse_error_exception, "Expected '\"' at the start of a key, got '${c}'", ("c", string(1, c)) );
+
+               const char* key = _p + 1;
+               skip_string();
+               const char* key_end = _p - 1;
+               const bool escaped = memchr( key, '\\', key_end - key ) != nullptr;
+
+               skip_white_space();
+               if( peek() != ':' )
+                  FC_THROW_EXCEPTION( parse_error_exception, "Expected ':' after key \"${key}\"", ("key", string(key, key_end)) );
+               ++_p;
+
+               const uint64_t matched = match( active & ~taken, depth, key, key_end, escaped, 0 );
+               taken |= matched;
+               if( matched )
+                  value( matched, depth + 1 );
+               else
+                  skip_value();
+            }
+         }
+
+         void array( uint64_t active, size_t depth )
+         {
+            ++_p;
+            for( uint32_t index = 0; ; )
+            {
+               skip_white_space();
+               const char c = peek();
+               if( c == ']' )
+               {
+                  ++_p;
+                  return;
+               }
+               if( c == ',' )
+               {
+                  ++_p;
+                  continue;
+               }
+
+               const uint64_t matched = match( active, depth, nullptr, nullptr, false, index++ );
+               if( matched )
+                  value( matched, depth + 1 );
+               else
+                  skip_value();
+            }
+         }
+
+         void skip_value()
+         {
+            skip_white_space();
+            switch( peek() )
+            {
+               case '"':
+                  skip_string();
+                  return;
+               case '{':
+               case '[':
+                  skip_container();
+                  return;
+               default:
+               {
+                  const char* start = _p;
+                  while( _p != _end && !is_delimiter( *_p ) )
+                     ++_p;
+                  if( _p == start )
+                     FC_THROW_EXCEPTION( parse_error_exception, "Unexpected '${c}'", ("c", string(1, *_p)) );
+               }
+            }
+         }
+
+         /** past the closing quote of the string at the current position */
+         void skip_string()
+         {
+            const char* start = _p + 1;
+            for( const char* q = start; ; ++q )
+            {
+               q = static_cast<const char*>( memchr( q, '"', _end - q ) );
+               if( !q )
+                  FC_THROW_EXCEPTION( parse_error_exception, "Unexpected EOF in string" );
+               const char* b = q;
+               while( b != start && b[-1] == '\\' )
+                  --b;
+               if( ( q - b ) % 2 == 0 )
+               {
+                  _p = q + 1;
+                  return;
+               }
+            }
+         }
+
+         /** past the bracket that closes the object or array at the current position */
+         void skip_container()
+         {
+            uint32_t open = 0;
+            while( true )
+            {
+               while( _p != _end && !structural.is[ uint8_t(*_p) ] )
+                  ++_p;
+               switch( peek() )
+               {
+                  case '"':
+                     skip_string();
+                     continue;
+                  case '{':
+                  case '[':
+                     ++open;
+                     break;
+                  default:
+                     if( --open == 0 )
+                     {
+                        ++_p;
+                        return;
+                     }
+               }
+               ++_p;
+            }
+         }
+
+         const std::vector< std::vector<json_extractor::step> >& _paths;
+         const char*                                              _p;
+         const char*                                              _end;
+         std::vector<json_slice>&                                 _out;
+   };
+
+   variant json_slice::parse( json::parse_type ptype )const
+   {
+      if( !found() )
+         return variant();
+      return json::from_string( str(), ptype );
+   }
+
+   json_extractor::json_extractor( std::vector<path> paths )
+   {
+      FC_ASSERT( paths.size() <= 64, "json_extractor takes at most 64 paths, got ${n}", ("n", paths.size()) );
+      _paths.reserve( paths.size() );
+      for( auto& p : paths )
+      {
+         std::vector<step> steps;
+         steps.reserve( p.size() );
+         for( auto& key : p )
+         {
+            const uint32_t index = to_index( key );
+            steps.push_back( step{ std::move( key ), index } );
+         }
+         _paths.push_back( std::move( steps ) );
+      }
+   }
+
+   std::vector<json_slice> json_extractor::slices( const char* data, size_t size )const
+   {
+      std::vector<json_slice> result( _paths.size() );
+      if( _paths.empty() )
+         return result;
+      json_scanner scanner( *this, data, size, result );
+      scanner.value( _paths.size() == 64 ? ~uint64_t(0) : ( uint64_t(1) << _paths.size() ) - 1, 0 );
+      return result;
+   }
+
+   variants json_extractor::values( const string& json, json::parse_type ptype )const
+   {
+      const std::vector<json_slice> found = slices( json.data(), json.size() );
+      variants result;
+      result.reserve( found.size() );
+      for( const auto& slice : found )
+         result.push_back( slice.parse( ptype ) );
+      return result;
+   }
+
+} // fc
@@ -0,0 +1,165 @@
+#include <fc/io/json_number.hpp>
+#include <fc/exception/exception.hpp>
+#include <boost/lexical_cast.hpp>
+#include <limits>
+
+namespace fc { namespace json_number
+{
+   namespace
+   {
+      inline bool is_digit( char c ) { return c >= '0' && c <= '9'; }
+
+      /** the value of 1 to 19 decimal digits, which always fits */
+      inline bool parse_digits( const char* begin, const char* end, uint64_t& value )
+      {
+         if( begin == end || end - begin > 19 )
+            return false;
+         value = 0;
+         for( const char* p = begin; p != end; ++p )
+         {
+            if( !is_digit( *p ) )
+               return false;
+            value = value * 10 + ( *p - '0' );
+         }
+         return true;
+      }
+
+      /** what fc::to_uint64() or fc::to_int64() do with string( begin, end ), without the string */
+      template<typename T>
+      T cast_integer( const char* begin, const char* end, const char* type )
+      {
+         try
+         {
+            return boost::lexical_cast<T>( begin, size_t( end - begin ) );
+         }
+         catch( const boost::bad_lexical_cast& )
+         {
+            FC_THROW_EXCEPTION( parse_error_exception, "Couldn't parse ${type}", ("type", type) );
+         }
+      }
+
+      /** the powers of ten that are exact doubles */
+      const double exact_powers[] = {
+         1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+      };
+      const int      max_exact_power = 22;
+      const uint64_t max_exact_mantissa = uint64_t(1) << 53;
+
+      /** the digits and the exponent of a decimal number, false if it is too long or has another form */
+      bool decompose( const char* p, const char* end, bool& negative, uint64_t& mantissa, int64_t& exponent )
+      {
+         negative = p != end && *p == '-';
+         if( negative )
+            ++p;
+
+         mantissa = 0;
+         exponent = 0;
+         int64_t significant = 0;
+         bool any = false;
+         for( ; p != end && is_digit( *p ); ++p )
+         {
+            any = true;
+            if( mantissa == 0 && *p == '0' )
+               continue;
+            if( ++significant > 19 )
+               return false;
+            mantissa = mantissa * 10 + ( *p - '0' );
+         }
+         if( p != end && *p == '.' )
+         {
+            // zeros only count once a digit follows them, trailing ones do not change the value
+            int64_t zeros = 0;
+            for( ++p; p != end && is_digit( *p ); ++p )
+            {
+               any = true;
+               if( *p == '0' )
+               {
+                  if( mantissa == 0 )
+                     --exponent;
+                  else
+                     ++zeros;
+                  continue;
+               }
+               significant += zeros + 1;
+               if( significant > 19 )
+                  return false;
+               exponent -= zeros + 1;
+               for( ; zeros; --zeros )
+                  mantissa *= 10;
+               mantissa = mantissa * 10 + ( *p - '0' );
+            }
+         }
+         if( !any )
+            return false;
+
+         if( p != end && ( *p == 'e' || *p == 'E' ) )
+         {
+            ++p;
+            bool negative_exponent = false;
+            if( p != end && ( *p == '+' || *p == '-' ) )
+               negative_exponent = *p++ == '-';
+            if( p == end )
+               return false;
+            int64_t e = 0;
+            for( ; p != end && is_digit( *p ); ++p )
+               if( e < 100000 )
+                  e = e * 10 + ( *p - '0' );
+            exponent += negative_exponent ? -e : e;
+         }
+         return p == end;
+      }
+   }
+
+   uint64_t to_uint64( const char* begin, const char* end )
+   {
+      uint64_t value;
+      if( parse_digits( begin, end, value ) )
+         return value;
+      return cast_integer<uint64_t>( begin, end, "uint64_t" );
+   }
+
+   int64_t to_int64( const char* begin, const char* end )
+   {
+      uint64_t value;
+      if( begin != end && *begin == '-' )
+      {
+         if( parse_digits( begin + 1, end, value ) && value <= uint64_t( std::numeric_limits<int64_t>::max() ) + 1 )
+            return value == uint64_t( std::numeric_limits<int64_t>::max() ) + 1 ? std::numeric_limits<int64_t>::min()
+                                                                                : -int64_t( value );
+      }
+      else if( parse_digits( begin, end, value ) && value <= uint64_t( std::numeric_limits<int64_t>::max() ) )
+         return int64_t( value );
+      return cast_integer<int64_t>( begin, end, "int64_t" );
+   }
+
+   double to_double( const char* begin, const char* end )
+   {
+      bool     negative;
+      uint64_t mantissa;
+      int64_t  exponent;
+      if( decompose( begin, end, negative, mantissa, exponent ) )
+      {
+         if( mantissa == 0 )
+            return negative ? -0.0 : 0.0;
+
+         // a mantissa short enough to take some of a larger power of ten exactly
+         while( exponent > max_exact_power && mantissa <= max_exact_mantissa / 10 )
+         {
+            mantissa *= 10;
+            --exponent;
+         }
+         if( mantissa <= max_exact_mantissa && exponent >= -max_exact_power && exponent <= max_exact_power )
+         {
+            double value = double( mantissa );
+            if( exponent < 0 )
+               value /= exact_powers[ -exponent ];
+            else
+               value *= exact_powers[ exponent ];
+            return negative ? -value : value;
+         }
+      }
+      return fc::to_double( string( begin, end ) );
+   }
+
+} } // fc::json_number
@@ -0,0 +1,327 @@
+#include <fc/io/json.hpp>
+#include <fc/io/iostream.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/exception/exception.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <ctype.h>
+#include <string.h>
+
+namespace fc
+{
+   namespace
+   {
+      /** containers and NDJSON with fewer elements are handled on the calling thread */
+      const size_t min_parallel_size = 4096;
+      /** the least elements a worker is handed at once, so handing them over does not dominate */
+      const size_t min_chunk_size = 1024;
+
+      /** the threads the chunks are handed to, each started the first time it is needed */
+      class json_workers
+      {
+         public:
+            /** @a threads of them, one per core if 0 */
+            static std::vector<fc::thread*> get( uint32_t threads )
+            {
+               static json_workers workers;
+               return workers.take( threads ? threads : std::max( 1u, boost::thread::hardware_concurrency() ) );
+            }
+
+         private:
+            std::vector<fc::thread*> take( size_t count )
+            {
+               std::lock_guard<std::mutex> lock( _mutex );
+               while( _threads.size() < count )
+                  _threads.emplace_back( "json " + fc::to_string( uint64_t( _threads.size() ) ) );
+               std::vector<fc::thread*> result;
+               for( size_t i = 0; i < count; ++i )
+                  result.push_back( &_threads[i] );
+               return result;
+            }
+
+            std::mutex              _mutex;
+            /** a deque, growing it leaves the threads handed out where they are */
+            std::deque<fc::thread>  _threads;
+      };
+
+      /**
+       *  Calls produce( first, last ) on the @a workers for chunks of [0, @a count), and
+       *  consume() with the results on the calling thread in the order of the chunks.  Only two
+       *  chunks per worker are in flight, so the results of a large container are not all held at
+       *  once.  An exception of produce() is rethrown once no chunk uses it any more.
+       */
+      template<typename Produce, typename Consume>
+      void in_chunks( size_t count, const std::vector<fc::thread*>& workers, const Produce& produce, Consume&& consume )
+      {
+         typedef decltype( produce( size_t(), size_t() ) ) result_type;
+         const size_t chunk = std::max( min_chunk_size, count / ( workers.size() * 4 ) + 1 );
+
+         std::deque< fc::future<result_type> > pending;
+         size_t next = 0;
+         size_t worker = 0;
+         try
+         {
+            while( next < count || !pending.empty() )
+            {
+               while( next < count && pending.size() < workers.size() * 2 )
+               {
+                  const size_t first = next;
+                  const size_t last = std::min( count, next + chunk );
+                  next = last;
+                  pending.push_back( workers[ worker++ % workers.size() ]->async(
+                     [&produce, first, last]() { return produce( first, last ); }, "json chunk" ) );
+               }
+               consume( pending.front().wait() );
+               pending.pop_front();
+            }
+         }
+         catch( ... )
+         {
+            for( auto& f : pending )
+            {
+               try { f.wait(); } catch( ... ) {}
+            }
+            throw;
+         }
+      }
+
+      /** writes like json_writer, but hands the elements of large containers to workers */
+      class parallel_writer
+      {
+         public:
+            parallel_writer( json_buffer& out, json::output_formatting format, uint32_t threads )
+            :_out(out),_format(format),_threads(threads){}
+
+            void write( const variant& v )
+            {
+               if( v.is_array() )
+                  write( v.get_array() );
+               else if( v.is_object() )
+                  write( v.get_object() );
+               else
+                  json_writer( _out, _format ).write( v );
+            }
+
+         private:
+            void write( const variants& a )
+            {
+               if( a.size() < min_parallel_size || workers().size() <= 1 )
+               {
+                  _out.open( '[' );
+                  for( size_t i = 0; i < a.size(); ++i )
+                  {
+                     if( i )
+                        _out.separator();
+                     write( a[i] );
+                     _out.maybe_flush();
+                  }
+                  _out.close( ']' );
+                  return;
+               }
+
+               _out.open( '[' );
+               write_chunks( a.size(), [&]( size_t first, size_t last ) -> string {
+                  string text;
+                  json_buffer buffer( text );
+                  json_writer writer( buffer, _format );
+                  for( size_t i = first; i < last; ++i )
+                  {
+                     if( i != first )
+                        buffer.separator();
+                     writer.write( a[i] );
+                  }
+                  return text;
+               });
+               _out.close( ']' );
+            }
+
+            void write( const variant_object& o )
+            {
+               if( o.size() < min_parallel_size || workers().size() <= 1 )
+               {
+                  _out.open( '{' );
+                  for( auto itr = o.begin(); itr != o.end(); ++itr )
+                  {
+                     if( itr != o.begin() )
+                        _out.separator();
+                     _out.write_string( itr->key().data(), itr->key().size() );
+                     _out.key_separator();
+                     write( itr->value() );
+                     _out.maybe_flush();
+                  }
+                  _out.close( '}' );
+                  return;
+               }
+
+               _out.open( '{' );
+               write_chunks( o.size(), [&]( size_t first, size_t last ) -> string {
+                  string text;
+                  json_buffer buffer( text );
+                  json_writer writer( buffer, _format );
+                  for( auto itr = o.begin() + first; itr != o.begin() + last; ++itr )
+                  {
+                     if( itr != o.begin() + first )
+                        buffer.separator();
+                     buffer.write_string( itr->key().data(), itr->key().size() );
+                     buffer.key_separator();
+                     writer.write( itr->value() );
+                  }
+                  return text;
+               });
+               _out.close( '}' );
+            }
+
+            template<typename Produce>
+            void write_chunks( size_t count, const Produce& produce )
+            {
+               bool first = true;
+               in_chunks( count, workers(), produce, [&]( const string& text ) {
+                  if( !first )
+                     _out.separator();
+                  first = false;
+                  _out.append( text.data(), text.size() );
+                  _out.maybe_flush();
+               });
+            }
+
+            /** taken the first time a container is large enough */
+            const std::vector<fc::thread*>& workers()
+            {
+               if( _workers.empty() )
+                  _workers = json_workers::get( _threads );
+               return _workers;
+            }
+
+            json_buffer&              _out;
+            json::output_formatting   _format;
+            uint32_t                  _threads;
+            std::vector<fc::thread*>  _workers;
+      };
+
+      /** the text of @a values from @a first to @a last, a line each */
+      string ndjson_lines( const variants& values, size_t first, size_t last, json::output_formatting format )
+      {
+         string text;
+         json_buffer buffer( text );
+         json_writer writer( buffer, format );
+         for( size_t i = first; i < last; ++i )
+         {
+            writer.write( values[i] );
+            text.push_back( '\n' );
+         }
+         return text;
+      }
+
+      void write_ndjson( json_buffer& out, const variants& values, json::output_formatting format, uint32_t threads )
+      {
+         const std::vector<fc::thread*> workers = values.size() < min_parallel_size ? std::vector<fc::thread*>()
+                                                                                     : json_workers::get( threads );
+         if( workers.size() <= 1 )
+         {
+            json_writer writer( out, format );
+            for( const auto& v : values )
+            {
+               writer.write( v );
+               out.append( "\n", 1 );
+               out.maybe_flush();
+            }
+            return;
+         }
+         in_chunks( values.size(), workers,
+                    [&]( size_t first, size_t last ) { return ndjson_lines( values, first, last, format ); },
+                    [&]( const string& text ) {
+                       out.append( text.data(), text.size() );
+                       out.maybe_flush();
+                    });
+      }
+
+      /** a line of NDJSON that is not blank */
+      struct ndjson_line
+      {
+         const char* data;
+         size_t      size;
+         size_t      number;
+      };
+
+      variant parse_line( const ndjson_line& line, json::parse_type ptype )
+      { try {
+         return json::from_string( string( line.data, line.size ), ptype );
+      } FC_RETHROW_EXCEPTIONS( warn, "Error parsing line ${line} of NDJSON", ("line", line.number) ) }
+   }
+
+   ostream& json::to_stream_parallel( ostream& out, const variant& v, output_formatting format, uint32_t threads )
+   {
+      json_buffer buffer( out );
+      parallel_writer( buffer, format, threads ).write( v );
+      buffer.flush();
+      return out;
+   }
+
+   string json::to_string_parallel( const variant& v, output_formatting format, uint32_t threads )
+   {
+      string text;
+      json_buffer buffer( text );
+      parallel_writer( buffer, format, threads ).write( v );
+      return text;
+   }
+
+   ostream& json::to_ndjson( ostream& out, const variants& values, output_formatting format, uint32_t threads )
+   {
+      json_buffer buffer( out );
+      write_ndjson( buffer, values, format, threads );
+      buffer.flush();
+      return out;
+   }
+
+   string json::to_ndjson( const variants& values, output_formatting format, uint32_t threads )
+   {
+      string text;
+      json_buffer buffer( text );
+      write_ndjson( buffer, values, format, threads );
+      return text;
+   }
+
+   variants json::variants_from_ndjson( const string& utf8_str, parse_type ptype, uint32_t threads )
+   {
+      std::vector<ndjson_line> lines;
+      const char* p = utf8_str.data();
+      const char* end = p + utf8_str.size();
+      for( size_t number = 1; p != end; ++number )
+      {
+         const char* eol = static_cast<const char*>( memchr( p, '\n', end - p ) );
+         if( !eol )
+            eol = end;
+         const char* first = p;
+         const char* last = eol;
+         while( last != first && isspace( uint8_t(last[-1]) ) )
+            --last;
+         while( first != last && isspace( uint8_t(*first) ) )
+            ++first;
+         if( first != last )
+            lines.push_back( ndjson_line{ first, size_t( last - first ), number } );
+         p = eol == end ? end : eol + 1;
+      }
+
+      variants result( lines.size() );
+      const std::vector<fc::thread*> workers = lines.size() < min_parallel_size ? std::vector<fc::thread*>()
+                                                                               : json_workers::get( threads );
+      if( workers.size() <= 1 )
+      {
+         for( size_t i = 0; i < lines.size(); ++i )
+            result[i] = parse_line( lines[i], ptype );
+         return result;
+      }
+      // the chunks fill elements of their own in result
+      in_chunks( lines.size(), workers,
+                 [&]( size_t first, size_t last ) {
+                    for( size_t i = first; i < last; ++i )
+                       result[i] = parse_line( lines[i], ptype );
+                    return last - first;
+                 },
+                 []( size_t ) {} );
+      return result;
+   }
+
+} // fc
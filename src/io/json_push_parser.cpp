@@ -0,0 +1,87 @@
+#include <fc/io/json_push_parser.hpp>
+#include <fc/io/json_sax.hpp>
+#include <fc/io/iostream.hpp>
+#include <fc/variant_limits.hpp>
+
+namespace fc
+{
+   namespace detail
+   {
+      /** the tokenizer of json_sax_parser with a json_subtree_reader that collects the top level values */
+      class json_push_parser_impl
+      {
+         public:
+            json_push_parser_impl( json::parse_type ptype, const parse_limits& limits )
+            :limits(limits),reader( 0, [this]( variant&& v ) { out->push_back( std::move( v ) ); } ),
+             tokenizer( reader, ptype )
+            {
+            }
+
+            void reset()
+            {
+               tokenizer.reset();
+               reader.reset();
+               bytes = sizeof(variant);
+               nodes = 0;
+            }
+
+            /** runs @a parse with the budget of the value in progress, @return the values it completed */
+            template<typename Parse>
+            variants budgeted( Parse&& parse )
+            {
+               variants completed;
+               parse_budget b( limits );
+               b.rewind( bytes, nodes );
+               out = &completed;
+               parse();
+               bytes = b.bytes();
+               nodes = b.nodes();
+               return completed;
+            }
+
+            const parse_limits   limits;
+            json_subtree_reader  reader;
+            json_sax_parser      tokenizer;
+            size_t               bytes = sizeof(variant);
+            uint32_t             nodes = 0;
+            variants*            out = nullptr;
+      };
+   }
+
+   json_push_parser::json_push_parser( json::parse_type ptype, const parse_limits& limits )
+   :my( new detail::json_push_parser_impl( ptype, limits ) )
+   {
+   }
+
+   json_push_parser::~json_push_parser()
+   {
+   }
+
+   variants json_push_parser::feed( const char* data, size_t size )
+   {
+      return my->budgeted( [&]() { my->tokenizer.feed( data, size ); } );
+   }
+
+   variants json_push_parser::feed( istream& in )
+   {
+      char buffer[4096];
+      const size_t size = in.readsome( buffer, sizeof(buffer) );
+      return feed( buffer, size );
+   }
+
+   variants json_push_parser::finish()
+   {
+      return my->budgeted( [&]() { my->tokenizer.finish(); } );
+   }
+
+   bool json_push_parser::idle()const
+   {
+      return my->tokenizer.idle();
+   }
+
+   void json_push_parser::reset()
+   {
+      my->reset();
+   }
+
+} // fc
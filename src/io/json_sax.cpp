@@ -0,0 +1,613 @@
+#include <fc/io/json_sax.hpp>
+#include <fc/io/json_number.hpp>
+#include <fc/io/iostream.hpp>
+#include <fc/variant_limits.hpp>
+#include <fc/exception/exception.hpp>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace fc
+{
+   namespace detail
+   {
+      /**
+       *  The legacy parser of json.cpp turned inside out: every place where it peeks at the next
+       *  character is a state, so the parse can stop at the end of any chunk and go on with the next.
+       */
+      class json_sax_parser_impl
+      {
+         public:
+            enum state_type
+            {
+               value_state,         ///< value_from_stream(), before a value
+               array_state,         ///< arrayFromStream(), before an element or ']'
+               object_state,        ///< objectFromStream(), before a key or '}'
+               colon_state,         ///< objectFromStream(), after a key
+               string_state,        ///< stringFromStream()
+               string_escape_state, ///< parseEscape() within a string
+               number_state,        ///< number_from_stream()
+               word_state,          ///< token_from_stream()
+               token_state,         ///< stringFromToken(), the unquoted words that become strings
+               token_escape_state   ///< parseEscape() within an unquoted word
+            };
+
+            json_sax_parser_impl( json_sax_handler& handler, json::parse_type ptype, bool check_only )
+            :handler(handler),string_doubles( ptype == json::legacy_parser_with_string_doubles ),keep_text( !check_only )
+            {
+               FC_ASSERT( ptype == json::legacy_parser || ptype == json::legacy_parser_with_string_doubles ||
+                          ptype == json::structural_parser, "json_sax_parser only supports the legacy parsers",
+                          ("ptype", ptype) );
+            }
+
+            void reset()
+            {
+               state = value_state;
+               objects.clear();
+               token.clear();
+               text_size = 0;
+               key_string = false;
+               dot = false;
+               read = 0;
+               position = 0;
+            }
+
+            /** @return the number of bytes read, up to the end of the next top level value if @a one_value */
+            size_t feed( const char* begin, const char* end, bool one_value )
+            {
+               budget = parse_budget::current();
+               value_done = false;
+               const char* p = begin;
+               while( p != end && !( one_value && value_done ) )
+               {
+                  position = read + size_t( p - begin );
+                  p = step( p, end );
+               }
+               read += size_t( p - begin );
+               position = read;
+               return size_t( p - begin );
+            }
+
+            void finish()
+            {
+               // objectFromStream() reports the end of the input as a parse error, arrayFromStream() passes it on
+               for( bool object : objects )
+                  if( object )
+                     FC_THROW_EXCEPTION( parse_error_exception, "Unexpected EOF" );
+               if( !objects.empty() || state == string_state || state == string_escape_state )
+                  FC_THROW_EXCEPTION( eof_exception, "unexpected end of file" );
+               switch( state )
+               {
+                  case number_state:
+                     end_number();
+                     break;
+                  case word_state:
+                     if( !end_word() )
+                        end_token();
+                     break;
+                  case token_state:
+                  case token_escape_state:
+                     end_token();
+                     break;
+                  default:
+                     break;
+               }
+               position = read;
+            }
+
+            bool idle()const { return state == value_state && objects.empty(); }
+
+            uint32_t depth()const { return uint32_t( objects.size() ); }
+
+            size_t offset()const { return position; }
+
+         private:
+            static bool is_white_space( char c ) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+            /** consumes characters in the current state, @return the first one left */
+            const char* step( const char* p, const char* end )
+            {
+               const char c = *p;
+               switch( state )
+               {
+                  case value_state:
+                     if( is_white_space( c ) )
+                        return p + 1;
+                     return begin_value( p );
+
+                  case array_state:
+                     if( c == ']' )
+                     {
+                        end_container();
+                        handler.on_end_array();
+                        return p + 1;
+                     }
+                     if( c == ',' || is_white_space( c ) )
+                        return p + 1;
+                     return begin_value( p );
+
+                  case object_state:
+                     if( c == '}' )
+                     {
+                        end_container();
+                        handler.on_end_object();
+                        return p + 1;
+                     }
+                     if( c == ',' || is_white_space( c ) )
+                        return p + 1;
+                     if( c != '"' )
+                        FC_THROW_EXCEPTION( parse_error_exception, "Expected '\"' but read '${char}'",
+                                            ("char", string( p, p + 1 )) );
+                     begin_string( true );
+                     return p + 1;
+
+                  case colon_state:
+                     if( is_white_space( c ) )
+                        return p + 1;
+                     if( c != ':' )
+                        FC_THROW_EXCEPTION( parse_error_exception, "Expected ':' after key \"${key}\"",
+                                            ("key", key) );
+                     state = value_state;
+                     return p + 1;
+
+                  case string_state:
+                  {
+                     const char* run = p;
+                     while( p != end && *p != '"' && *p != '\\' && *p != 0x04 )
+                        ++p;
+                     if( keep_text )
+                        token.append( run, p );
+                     text_size += size_t( p - run );
+                     position += size_t( p - run );
+                     if( budget )
+                        budget->check_bytes( text_size );
+                     if( p == end )
+                        return p;
+                     if( *p == '\\' )
+                        state = string_escape_state;
+                     else if( *p == '"' )
+                        end_string();
+                     else
+                        FC_THROW_EXCEPTION( parse_error_exception, "EOF before closing '\"' in string '${token}'",
+                                            ("token", token) );
+                     return p + 1;
+                  }
+
+                  case string_escape_state:
+                     append_text( unescape( c ) );
+                     state = string_state;
+                     return p + 1;
+
+                  case number_state:
+                     if( c >= '0' && c <= '9' )
+                     {
+                        token += c;
+                        return p + 1;
+                     }
+                     if( c == '.' )
+                     {
+                        if( dot )
+                           FC_THROW_EXCEPTION( parse_error_exception, "Can't parse a number with two decimal places" );
+                        dot = true;
+                        token += c;
+                        return p + 1;
+                     }
+                     if( isalnum( (unsigned char)c ) )
+                     {
+                        state = token_state;
+                        return p;
+                     }
+                     end_number();
+                     return p;
+
+                  case word_state:
+                     if( c != 0 && strchr( "nultreafs", c ) )
+                     {
+                        // a word longer than "false" is no keyword, when only checking it is not kept
+                        if( keep_text || token.size() <= 5 )
+                           token += c;
+                        return p + 1;
+                     }
+                     if( !end_word() )
+                        state = token_state;
+                     return p;
+
+                  case token_state:
+                     switch( c )
+                     {
+                        case '\\':
+                           state = token_escape_state;
+                           return p + 1;
+                        case '\t':
+                        case ' ':
+                        case '\0':
+                        case '\n':
+                           end_token();
+                           return p + 1;
+                        default:
+                           if( isalnum( (unsigned char)c ) || c == '_' || c == '-' || c == '.' || c == ':' || c == '/' )
+                           {
+                              append_text( c );
+                              return p + 1;
+                           }
+                           end_token();
+                           return p;
+                     }
+
+                  case token_escape_state:
+                     append_text( unescape( c ) );
+                     state = token_state;
+                     return p + 1;
+               }
+               return p;
+            }
+
+            const char* begin_value( const char* p )
+            {
+               const signed char c = *p;
+               switch( c )
+               {
+                  case '"':
+                     begin_string( false );
+                     return p + 1;
+                  case '{':
+                     objects.push_back( true );
+                     state = object_state;
+                     handler.on_start_object();
+                     return p + 1;
+                  case '[':
+                     objects.push_back( false );
+                     state = array_state;
+                     handler.on_start_array();
+                     return p + 1;
+                  case '-':
+                  case '.':
+                  case '0': case '1': case '2': case '3': case '4':
+                  case '5': case '6': case '7': case '8': case '9':
+                     token.assign( 1, c );
+                     dot = c == '.';
+                     number_start = position;
+                     state = number_state;
+                     return p + 1;
+                  case 'n':
+                  case 't':
+                  case 'f':
+                     token.assign( 1, c );
+                     state = word_state;
+                     return p + 1;
+                  case 0x04: // ^D end of transmission
+                  case EOF:
+                  case 0:
+                     FC_THROW_EXCEPTION( eof_exception, "unexpected end of file" );
+                  default:
+                     FC_THROW_EXCEPTION( parse_error_exception, "Unexpected char '${c}'", ("c", c) );
+               }
+            }
+
+            /** a character of a string or an unquoted word, kept unless only checking */
+            void append_text( char c )
+            {
+               if( keep_text )
+                  token += c;
+               ++text_size;
+            }
+
+            static char unescape( char c )
+            {
+               switch( c )
+               {
+                  case 't': return '\t';
+                  case 'n': return '\n';
+                  case 'r': return '\r';
+                  default:  return c;
+               }
+            }
+
+            /** the state after a value, in its container or at the top level */
+            void end_value()
+            {
+               token.clear();
+               text_size = 0;
+               value_done = objects.empty();
+               state = value_done ? value_state : objects.back() ? object_state : array_state;
+            }
+
+            void end_container()
+            {
+               objects.pop_back();
+               end_value();
+            }
+
+            void begin_string( bool is_key )
+            {
+               token.clear();
+               text_size = 0;
+               key_string = is_key;
+               state = string_state;
+            }
+
+            void end_string()
+            {
+               if( key_string )
+               {
+                  state = colon_state;
+                  if( keep_text )
+                  {
+                     key = token;
+                     handler.on_key( std::move( token ) );
+                  }
+                  else
+                     handler.on_key( string() );
+                  token.clear();
+               }
+               else
+                  end_token();
+            }
+
+            void end_token()
+            {
+               string s;
+               if( keep_text )
+                  s = std::move( token );
+               end_value();
+               handler.on_string( std::move( s ) );
+            }
+
+            void end_number()
+            {
+               position = number_start;
+               if( token == "-." || token == "." )
+                  FC_THROW_EXCEPTION( parse_error_exception, "Can't parse token \"${token}\" as a JSON numeric constant",
+                                      ("token", token) );
+               if( dot && string_doubles )
+                  return end_token();
+               // converted before end_value() clears the token, which keeps its buffer for the next one
+               const char* begin = token.data();
+               const char* end = begin + token.size();
+               if( dot )
+               {
+                  const double d = json_number::to_double( begin, end );
+                  end_value();
+                  handler.on_double( d );
+               }
+               else if( *begin == '-' )
+               {
+                  const int64_t i = json_number::to_int64( begin, end );
+                  end_value();
+                  handler.on_int64( i );
+               }
+               else
+               {
+                  const uint64_t u = json_number::to_uint64( begin, end );
+                  end_value();
+                  handler.on_uint64( u );
+               }
+            }
+
+            /** @return false if the word is not null, true or false and goes on as an unquoted string */
+            bool end_word()
+            {
+               if( token == "null" )
+               {
+                  end_value();
+                  handler.on_null();
+               }
+               else if( token == "true" || token == "false" )
+               {
+                  const bool b = token[0] == 't';
+                  end_value();
+                  handler.on_bool( b );
+               }
+               else
+                  return false;
+               return true;
+            }
+
+            json_sax_handler&   handler;
+            const bool          string_doubles;
+            /** false when only checking, strings, keys and unquoted words are then not kept */
+            const bool          keep_text;
+            state_type          state = value_state;
+            /** true for the open objects, false for the open arrays */
+            std::vector<bool>   objects;
+            string              token;
+            /** the length of the string being read, which token only holds if keep_text */
+            size_t              text_size = 0;
+            /** the last key, for the error message of a missing colon */
+            string              key;
+            bool                key_string = false;
+            bool                dot = false;
+            /** set when a top level value is complete */
+            bool                value_done = false;
+            /** the bytes fed so far, and the offset for offset() */
+            size_t              read = 0;
+            size_t              position = 0;
+            size_t              number_start = 0;
+            parse_budget*       budget = nullptr;
+      };
+   }
+
+   json_sax_parser::json_sax_parser( json_sax_handler& handler, json::parse_type ptype, bool check_only )
+   :my( new detail::json_sax_parser_impl( handler, ptype, check_only ) )
+   {
+   }
+
+   json_sax_parser::~json_sax_parser()
+   {
+   }
+
+   void json_sax_parser::feed( const char* data, size_t size )
+   {
+      my->feed( data, data + size, false );
+   }
+
+   size_t json_sax_parser::feed_value( const char* data, size_t size )
+   {
+      return my->feed( data, data + size, true );
+   }
+
+   void json_sax_parser::feed( istream& in )
+   {
+      char buffer[4096];
+      const size_t size = in.readsome( buffer, sizeof(buffer) );
+      feed( buffer, size );
+   }
+
+   void json_sax_parser::finish()
+   {
+      my->finish();
+   }
+
+   bool json_sax_parser::idle()const
+   {
+      return my->idle();
+   }
+
+   uint32_t json_sax_parser::depth()const
+   {
+      return my->depth();
+   }
+
+   size_t json_sax_parser::offset()const
+   {
+      return my->offset();
+   }
+
+   void json_sax_parser::reset()
+   {
+      my->reset();
+   }
+
+   void json_sax_parser::parse( const char* data, size_t size, json_sax_handler& handler, json::parse_type ptype )
+   {
+      json_sax_parser parser( handler, ptype );
+      parser.feed( data, size );
+      parser.finish();
+   }
+
+   void json_sax_parser::parse( istream& in, json_sax_handler& handler, json::parse_type ptype )
+   {
+      json_sax_parser parser( handler, ptype );
+      char buffer[4096];
+      while( true )
+      {
+         size_t size = 0;
+         try
+         {
+            size = in.readsome( buffer, sizeof(buffer) );
+         }
+         catch( const eof_exception& )
+         {
+            break;
+         }
+         parser.feed( buffer, size );
+      }
+      parser.finish();
+   }
+
+   // ---------------------------------------------------------------
+   // json_subtree_reader
+
+   json_subtree_reader::json_subtree_reader( uint32_t depth, callback on_value )
+   :_depth(depth),_on_value( std::move( on_value ) )
+   {
+   }
+
+   void json_subtree_reader::read( const char* data, size_t size, uint32_t depth, const callback& on_value,
+                                   const parse_limits& limits, json::parse_type ptype )
+   {
+      parse_budget budget( limits );
+      json_subtree_reader reader( depth, on_value );
+      json_sax_parser::parse( data, size, reader, ptype );
+   }
+
+   void json_subtree_reader::read( istream& in, uint32_t depth, const callback& on_value,
+                                   const parse_limits& limits, json::parse_type ptype )
+   {
+      parse_budget budget( limits );
+      json_subtree_reader reader( depth, on_value );
+      json_sax_parser::parse( in, reader, ptype );
+   }
+
+   void json_subtree_reader::reset()
+   {
+      _open = 0;
+      _frames.clear();
+   }
+
+   bool json_subtree_reader::begin_value()
+   {
+      if( _frames.empty() && _open < _depth )
+         return false;
+      if( parse_budget* budget = parse_budget::current() )
+         budget->check_depth( uint32_t( _frames.size() ) );
+      return true;
+   }
+
+   void json_subtree_reader::complete( variant&& v )
+   {
+      parse_budget* budget = parse_budget::current();
+      if( budget )
+         budget->add_node( estimated_node_size( v ) );
+      if( _frames.empty() )
+      {
+         _on_value( std::move( v ) );
+         if( budget )
+            budget->rewind( sizeof(variant), 0 );
+      }
+      else if( _frames.back().object )
+      {
+         frame& f = _frames.back();
+         f.members( std::move( f.key ), std::move( v ) );
+      }
+      else
+         _frames.back().elements.push_back( std::move( v ) );
+   }
+
+   void json_subtree_reader::on_start_object()
+   {
+      if( begin_value() )
+         _frames.emplace_back( true );
+      else
+         ++_open;
+   }
+
+   void json_subtree_reader::on_key( string&& key )
+   {
+      if( !_frames.empty() )
+         _frames.back().key = std::move( key );
+   }
+
+   void json_subtree_reader::on_end_object()
+   {
+      if( _frames.empty() )
+      {
+         --_open;
+         return;
+      }
+      variant v( variant_object( std::move( _frames.back().members ) ) );
+      _frames.pop_back();
+      complete( std::move( v ) );
+   }
+
+   void json_subtree_reader::on_start_array()
+   {
+      if( begin_value() )
+         _frames.emplace_back( false );
+      else
+         ++_open;
+   }
+
+   void json_subtree_reader::on_end_array()
+   {
+      if( _frames.empty() )
+      {
+         --_open;
+         return;
+      }
+      variant v( std::move( _frames.back().elements ) );
+      _frames.pop_back();
+      complete( std::move( v ) );
+   }
+
+} // fc
@@ -0,0 +1,463 @@
+#include <fc/io/json_structural.hpp>
+#include <fc/io/json_number.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/variant_limits.hpp>
+#include <fc/exception/exception.hpp>
+#include <ctype.h>
+#include <string.h>
+#include <limits>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define FC_JSON_STRUCTURAL_X86
+#include <immintrin.h>
+#endif
+
+namespace fc { namespace json_structural
+{
+   namespace
+   {
+      inline unsigned lowest_bit( uint64_t bits )
+      {
+#ifdef __GNUC__
+         return __builtin_ctzll( bits );
+#else
+         unsigned bit = 0;
+         while( !( bits & 1 ) ) { bits >>= 1; ++bit; }
+         return bit;
+#endif
+      }
+
+      /** turns the character masks of consecutive 64 byte blocks into index positions */
+      class index_builder
+      {
+         public:
+            explicit index_builder( structural_index& index ):_index(index){}
+
+            void add_block( uint32_t base, uint64_t quotes, uint64_t backslashes, uint64_t terminators )
+            {
+               if( terminators )
+                  _index.has_terminator = true;
+
+               // a backslash escapes the next character, which may be in the next block
+               uint64_t escaped = 0;
+               if( backslashes | _escape_next )
+               {
+                  escaped = _escape_next;
+                  uint64_t escapes = backslashes & ~_escape_next;
+                  _escape_next = 0;
+                  while( escapes )
+                  {
+                     const unsigned bit = lowest_bit( escapes );
+                     escapes &= escapes - 1;
+                     if( bit == 63 )
+                        _escape_next = 1;
+                     else
+                     {
+                        escaped |= uint64_t(2) << bit;
+                        escapes &= ~( uint64_t(2) << bit );
+                     }
+                  }
+               }
+
+               uint64_t marks = ( quotes | backslashes ) & ~escaped;
+               while( marks )
+               {
+                  _index.positions.push_back( base + lowest_bit( marks ) );
+                  marks &= marks - 1;
+               }
+            }
+
+         private:
+            structural_index&  _index;
+            uint64_t           _escape_next = 0;
+      };
+
+      void index_scalar( const char* data, size_t size, size_t start, index_builder& builder )
+      {
+         for( size_t i = start; i < size; i += 64 )
+         {
+            const size_t n = std::min<size_t>( 64, size - i );
+            uint64_t quotes = 0, backslashes = 0, terminators = 0;
+            for( size_t j = 0; j < n; ++j )
+            {
+               const uint64_t bit = uint64_t(1) << j;
+               switch( data[i + j] )
+               {
+                  case '"':  quotes |= bit; break;
+                  case '\\': backslashes |= bit; break;
+                  case 0:
+                  case 0x04: terminators |= bit; break;
+                  default: break;
+               }
+            }
+            builder.add_block( uint32_t(i), quotes, backslashes, terminators );
+         }
+      }
+
+#ifdef FC_JSON_STRUCTURAL_X86
+      /** @return the number of bytes indexed, a multiple of 64 */
+      __attribute__((target("sse2")))
+      size_t index_sse2( const char* data, size_t size, index_builder& builder )
+      {
+         const __m128i quote     = _mm_set1_epi8( '"' );
+         const __m128i backslash = _mm_set1_epi8( '\\' );
+         const __m128i nul       = _mm_setzero_si128();
+         const __m128i eot       = _mm_set1_epi8( 0x04 );
+         size_t i = 0;
+         for( ; i + 64 <= size; i += 64 )
+         {
+            uint64_t quotes = 0, backslashes = 0, terminators = 0;
+            for( int j = 0; j < 4; ++j )
+            {
+               const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + i + 16 * j ) );
+               quotes      |= uint64_t( uint32_t( _mm_movemask_epi8( _mm_cmpeq_epi8( v, quote ) ) ) ) << ( 16 * j );
+               backslashes |= uint64_t( uint32_t( _mm_movemask_epi8( _mm_cmpeq_epi8( v, backslash ) ) ) ) << ( 16 * j );
+               terminators |= uint64_t( uint32_t( _mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi8( v, nul ),
+                                                                                    _mm_cmpeq_epi8( v, eot ) ) ) ) ) << ( 16 * j );
+            }
+            builder.add_block( uint32_t(i), quotes, backslashes, terminators );
+         }
+         return i;
+      }
+
+      __attribute__((target("avx2")))
+      size_t index_avx2( const char* data, size_t size, index_builder& builder )
+      {
+         const __m256i quote     = _mm256_set1_epi8( '"' );
+         const __m256i backslash = _mm256_set1_epi8( '\\' );
+         const __m256i nul       = _mm256_setzero_si256();
+         const __m256i eot       = _mm256_set1_epi8( 0x04 );
+         size_t i = 0;
+         for( ; i + 64 <= size; i += 64 )
+         {
+            uint64_t quotes = 0, backslashes = 0, terminators = 0;
+            for( int j = 0; j < 2; ++j )
+            {
+               const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data + i + 32 * j ) );
+               quotes      |= uint64_t( uint32_t( _mm256_movemask_epi8( _mm256_cmpeq_epi8( v, quote ) ) ) ) << ( 32 * j );
+               backslashes |= uint64_t( uint32_t( _mm256_movemask_epi8( _mm256_cmpeq_epi8( v, backslash ) ) ) ) << ( 32 * j );
+               terminators |= uint64_t( uint32_t( _mm256_movemask_epi8( _mm256_or_si256( _mm256_cmpeq_epi8( v, nul ),
+                                                                                          _mm256_cmpeq_epi8( v, eot ) ) ) ) ) << ( 32 * j );
+            }
+            builder.add_block( uint32_t(i), quotes, backslashes, terminators );
+         }
+         return i;
+      }
+
+      /** @return the first character to escape in whole blocks of 16 bytes, or the start of the rest */
+      __attribute__((target("sse2")))
+      const char* find_escape_sse2( const char* p, const char* end )
+      {
+         const __m128i quote     = _mm_set1_epi8( '"' );
+         const __m128i backslash = _mm_set1_epi8( '\\' );
+         const __m128i control   = _mm_set1_epi8( 0x1f );
+         for( ; end - p >= 16; p += 16 )
+         {
+            const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+            const __m128i escapes = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( v, quote ), _mm_cmpeq_epi8( v, backslash ) ),
+                                                  _mm_cmpeq_epi8( _mm_min_epu8( v, control ), v ) );
+            if( const uint32_t mask = _mm_movemask_epi8( escapes ) )
+               return p + lowest_bit( mask );
+         }
+         return p;
+      }
+
+      __attribute__((target("avx2")))
+      const char* find_escape_avx2( const char* p, const char* end )
+      {
+         const __m256i quote     = _mm256_set1_epi8( '"' );
+         const __m256i backslash = _mm256_set1_epi8( '\\' );
+         const __m256i control   = _mm256_set1_epi8( 0x1f );
+         for( ; end - p >= 32; p += 32 )
+         {
+            const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p ) );
+            const __m256i escapes = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( v, quote ), _mm256_cmpeq_epi8( v, backslash ) ),
+                                                     _mm256_cmpeq_epi8( _mm256_min_epu8( v, control ), v ) );
+            if( const uint32_t mask = _mm256_movemask_epi8( escapes ) )
+               return p + lowest_bit( mask );
+         }
+         return find_escape_sse2( p, end );
+      }
+
+      bool has_avx2()
+      {
+         __builtin_cpu_init();
+         return __builtin_cpu_supports( "avx2" );
+      }
+#endif
+
+      /** thrown where the legacy parser would fail or read something else than strict JSON */
+      struct fallback {};
+
+      /**
+       *  Follows variant_from_stream() of the legacy parser, including the commas and white space
+       *  it skips, but finds the end of strings and their escapes from the index.
+       */
+      class parser
+      {
+         public:
+            parser( const char* data, size_t size, const structural_index& index )
+            :_begin(data),_p(data),_end(data + size),
+             _mark(index.positions.data()),_marks_end(index.positions.data() + index.positions.size()){}
+
+            variant parse_variant()
+            {
+               return budgeted_parse( [&]() { return parse_value(); } );
+            }
+
+         private:
+            [[noreturn]] void fail()const { throw fallback(); }
+
+            char peek()const
+            {
+               if( _p == _end )
+                  fail();
+               return *_p;
+            }
+
+            bool skip_white_space()
+            {
+               const char* start = _p;
+               while( _p != _end && ( *_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r' ) )
+                  ++_p;
+               return _p != start;
+            }
+
+            variant parse_value()
+            {
+               skip_white_space();
+               switch( peek() )
+               {
+                  case '"':
+                     return parse_string();
+                  case '{':
+                     return parse_object();
+                  case '[':
+                     return parse_array();
+                  case '-':
+                  case '.':
+                  case '0': case '1': case '2': case '3': case '4':
+                  case '5': case '6': case '7': case '8': case '9':
+                     return parse_number();
+                  case 'n':
+                  case 't':
+                  case 'f':
+                     return parse_word();
+                  default:
+                     fail();
+               }
+            }
+
+            string parse_string()
+            {
+               const uint32_t open = uint32_t( _p - _begin );
+               while( _mark != _marks_end && *_mark < open )
+                  ++_mark;
+               if( _mark == _marks_end || *_mark != open )
+                  fail();
+               ++_mark;
+
+               string result;
+               parse_budget::growth growth;
+               const char* segment = _p + 1;
+               while( true )
+               {
+                  if( _mark == _marks_end )
+                     fail();
+                  const char* mark = _begin + *_mark++;
+                  growth.grow_to( result.size() + ( mark - segment ) + 1 );
+                  result.append( segment, mark );
+                  if( *mark == '"' )
+                  {
+                     _p = mark + 1;
+                     return result;
+                  }
+                  // an escape, see parseEscape()
+                  if( mark + 1 == _end )
+                     fail();
+                  switch( mark[1] )
+                  {
+                     case 't': result += '\t'; break;
+                     case 'n': result += '\n'; break;
+                     case 'r': result += '\r'; break;
+                     default:  result += mark[1]; break;
+                  }
+                  segment = mark + 2;
+               }
+            }
+
+            variant parse_object()
+            {
+               mutable_variant_object obj;
+               parse_budget::growth growth;
+               size_t key_bytes = 0;
+               ++_p;
+               skip_white_space();
+               while( peek() != '}' )
+               {
+                  if( *_p == ',' )
+                  {
+                     ++_p;
+                     continue;
+                  }
+                  if( skip_white_space() ) continue;
+                  if( *_p != '"' )
+                     fail();
+                  string key = parse_string();
+                  skip_white_space();
+                  if( peek() != ':' )
+                     fail();
+                  ++_p;
+                  variant val = parse_variant();
+                  key_bytes += key.size();
+                  obj( std::move(key), std::move(val) );
+                  growth.grow_to( obj.size() * sizeof(variant_object::entry) + key_bytes );
+                  skip_white_space();
+               }
+               ++_p;
+               return variant_object( std::move(obj) );
+            }
+
+            variant parse_array()
+            {
+               variants ar;
+               parse_budget::growth growth;
+               ++_p;
+               skip_white_space();
+               while( peek() != ']' )
+               {
+                  if( *_p == ',' )
+                  {
+                     ++_p;
+                     continue;
+                  }
+                  if( skip_white_space() ) continue;
+                  ar.push_back( parse_variant() );
+                  growth.grow_to( ar.capacity() * sizeof(variant) );
+                  skip_white_space();
+               }
+               ++_p;
+               return ar;
+            }
+
+            /** the legacy parser turns numbers followed by letters into strings, those fall back */
+            variant parse_number()
+            {
+               const char* start = _p;
+               const bool neg = *_p == '-';
+               if( neg )
+                  ++_p;
+               bool dot = false;
+               for( ; _p != _end; ++_p )
+               {
+                  const char c = *_p;
+                  if( c == '.' )
+                  {
+                     if( dot )
+                        fail();
+                     dot = true;
+                  }
+                  else if( c < '0' || c > '9' )
+                  {
+                     if( isalnum( c ) )
+                        fail();
+                     break;
+                  }
+               }
+               const size_t size = _p - start;
+               if( ( size == 1 && *start == '.' ) || ( size == 2 && neg && start[1] == '.' ) )
+                  fail();
+               try
+               {
+                  if( dot )
+                     return json_number::to_double( start, _p );
+                  if( neg )
+                     return json_number::to_int64( start, _p );
+                  return json_number::to_uint64( start, _p );
+               }
+               catch( const fc::exception& )
+               {
+                  fail();
+               }
+            }
+
+            /** only null, true and false, the legacy parser reads other words as strings */
+            variant parse_word()
+            {
+               const char* start = _p;
+               while( _p != _end && *_p != 0 && strchr( "nultreafs", *_p ) )
+                  ++_p;
+               const size_t len = _p - start;
+               if( len == 4 && memcmp( start, "null", 4 ) == 0 )
+                  return variant();
+               if( len == 4 && memcmp( start, "true", 4 ) == 0 )
+                  return variant( true );
+               if( len == 5 && memcmp( start, "false", 5 ) == 0 )
+                  return variant( false );
+               fail();
+            }
+
+            const char*       _begin;
+            const char*       _p;
+            const char*       _end;
+            const uint32_t*   _mark;
+            const uint32_t*   _marks_end;
+      };
+   }
+
+   void build_index( const char* data, size_t size, structural_index& index )
+   {
+      index.positions.clear();
+      index.has_terminator = false;
+      index_builder builder( index );
+      size_t indexed = 0;
+#ifdef FC_JSON_STRUCTURAL_X86
+      static const bool avx2 = has_avx2();
+      indexed = avx2 ? index_avx2( data, size, builder ) : index_sse2( data, size, builder );
+#endif
+      index_scalar( data, size, indexed, builder );
+   }
+
+   const char* find_escape_in_blocks( const char* begin, const char* end )
+   {
+      const char* p = begin;
+#ifdef FC_JSON_STRUCTURAL_X86
+      static const bool avx2 = has_avx2();
+      p = avx2 ? find_escape_avx2( p, end ) : find_escape_sse2( p, end );
+#endif
+      for( ; p != end; ++p )
+      {
+         const unsigned char c = *p;
+         if( c < 0x20 || c == '"' || c == '\\' )
+            break;
+      }
+      return p;
+   }
+
+   bool parse( const char* data, size_t size, variant& result )
+   {
+      if( size >= std::numeric_limits<uint32_t>::max() )
+         return false;
+
+      structural_index index;
+      build_index( data, size, index );
+      if( index.has_terminator )
+         return false;
+
+      parse_budget* budget = parse_budget::current();
+      const size_t   bytes = budget ? budget->bytes() : 0;
+      const uint32_t nodes = budget ? budget->nodes() : 0;
+      try
+      {
+         result = parser( data, size, index ).parse_variant();
+         return true;
+      }
+      catch( const fallback& )
+      {
+         if( budget )
+            budget->rewind( bytes, nodes );
+         return false;
+      }
+   }
+
+} } // fc::json_structural
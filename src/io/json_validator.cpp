@@ -0,0 +1,438 @@
+#include <fc/io/json_validator.hpp>
+#include <fc/io/json_number.hpp>
+#include <fc/exception/exception.hpp>
+#include <string.h>
+
+namespace fc { namespace json_validator
+{
+   namespace
+   {
+      inline bool is_white_space( char c ) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+      inline bool is_digit( char c ) { return c >= '0' && c <= '9'; }
+
+      inline bool is_letter( char c ) { return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ); }
+
+      /** the characters of an unquoted word of the relaxed parsers, see json_relaxed::tokenFromStream() */
+      inline bool is_word_char( char c )
+      {
+         return is_letter( c ) || is_digit( c ) || c == '_' || c == '-' || c == '.' || c == '+' || c == '/';
+      }
+
+      inline char unescape( char c )
+      {
+         switch( c )
+         {
+            case 't': return '\t';
+            case 'n': return '\n';
+            case 'r': return '\r';
+            default:  return c;
+         }
+      }
+
+      /** what to_double() would say about the @a n characters at @a s */
+      bool converts_to_double( const char* s, size_t n )
+      {
+         try
+         {
+            json_number::to_double( s, s + n );
+            return true;
+         }
+         catch( const fc::exception& )
+         {
+            return false;
+         }
+      }
+
+      /** to_uint64() or, with a minus sign, to_int64() of the decimal digits in [@a begin, @a end) */
+      bool integer_fits( const char* begin, const char* end, bool negative )
+      {
+         if( begin == end )
+            return false;
+         uint64_t value = 0;
+         for( const char* p = begin; p != end; ++p )
+         {
+            const uint64_t digit = *p - '0';
+            if( value > ( std::numeric_limits<uint64_t>::max() - digit ) / 10 )
+               return false;
+            value = value * 10 + digit;
+         }
+         return !negative || value <= uint64_t( std::numeric_limits<int64_t>::max() ) + 1;
+      }
+
+      /**
+       *  Whether json_relaxed::parseNumberOrStr() accepts the decoded word @a t of @a n characters,
+       *  as a number for the strict parser and as a number or a string for the relaxed one.
+       */
+      bool relaxed_number( const char* t, size_t n, bool strict )
+      {
+         // parseNumberOrStr() reads token[n], which is the terminating NUL of the string
+         auto at = [&]( size_t i ) { return i < n ? t[i] : '\0'; };
+
+         size_t i = 0;
+         if( t[0] == '+' )
+         {
+            if( strict )
+               return false;
+            ++i;
+         }
+         else if( t[0] == '-' )
+            ++i;
+
+         const char first = at( i++ );
+         if( first == '0' )
+         {
+            if( i >= n )
+               return true;
+            switch( t[i] )
+            {
+               case 'b':
+               case 'B':
+                  // a binary literal that does not parse becomes a string, an empty one is an error
+                  return !strict && i + 1 < n;
+               case 'o':
+               case 'O':
+               case 'x':
+               case 'X':
+                  return !strict;
+               case '.':
+               case 'e':
+               case 'E':
+                  break;
+               default:
+                  if( strict )
+                     return false;
+            }
+         }
+         else if( !is_digit( first ) )
+            return is_word_char( first ) && !strict;
+
+         const size_t start = i - 1;
+         while( true )
+         {
+            if( i >= n )
+               return integer_fits( t + start, t + n, t[0] == '-' );
+            const char c = t[i++];
+            if( is_digit( c ) )
+               continue;
+            if( c == '.' )
+               return !strict;
+            if( c != 'e' && c != 'E' )
+               return ( is_letter( c ) || c == '_' || c == '-' || c == '+' || c == '/' ) && !strict;
+
+            if( i == n )
+               return !strict;
+            const char sign = t[i++];
+            if( sign == '+' || sign == '-' )
+            {
+               if( i == n )
+                  return !strict;
+            }
+            else if( !is_digit( sign ) )
+               return ( is_letter( sign ) || sign == '_' || sign == '.' || sign == '/' ) && !strict;
+            // other characters of the exponent are skipped and left to to_double()
+            while( i != n )
+            {
+               const char e = t[i++];
+               if( !is_digit( e ) && is_word_char( e ) )
+                  return !strict;
+            }
+            return converts_to_double( t, strnlen( t, n ) );
+         }
+      }
+
+      /**
+       *  Follows json_relaxed::variant_from_stream() over a buffer.  The containers are kept as a
+       *  bit per level instead of a recursion, the rest are the same loops without the tokens.
+       */
+      class validator
+      {
+         public:
+            validator( const char* data, size_t size, bool strict )
+            :_begin(data),_p(data),_end(data + size),_strict(strict){}
+
+            bool validate( size_t& error_offset )
+            {
+               if( document() )
+                  return true;
+               error_offset = _error;
+               return false;
+            }
+
+         private:
+            bool fail( const char* at )
+            {
+               _error = at - _begin;
+               return false;
+            }
+
+            void skip_white_space()
+            {
+               while( _p != _end && is_white_space( *_p ) )
+                  ++_p;
+            }
+
+            /** the value and, for a container, arrayFromStream() or objectFromStream() up to its end */
+            bool document()
+            {
+               uint64_t objects[max_depth / 64];
+               uint32_t depth = 0;
+               skip_white_space();
+               if( !value( objects, depth ) )
+                  return false;
+               while( depth > 0 )
+               {
+                  const bool object = ( objects[( depth - 1 ) / 64] >> ( ( depth - 1 ) % 64 ) ) & 1;
+                  if( _p == _end )
+                     return fail( _p );
+                  const char c = *_p;
+                  if( c == ( object ? '}' : ']' ) )
+                  {
+                     ++_p;
+                     --depth;
+                     continue;
+                  }
+                  if( c == ',' || is_white_space( c ) )
+                  {
+                     ++_p;
+                     continue;
+                  }
+                  if( object )
+                  {
+                     if( !relaxed_key() )
+                        return false;
+                     skip_white_space();
+                     if( _p == _end || *_p != ':' )
+                        return fail( _p );
+                     ++_p;
+                     skip_white_space();
+                  }
+                  if( !value( objects, depth ) )
+                     return false;
+               }
+               return _p == _end || fail( _p );
+            }
+
+            /** a scalar, or the opening of a container */
+            bool value( uint64_t* objects, uint32_t& depth )
+            {
+               if( _p == _end )
+                  return fail( _p );
+               const char c = *_p;
+               if( c == '{' || c == '[' )
+               {
+                  if( depth == max_depth )
+                     return fail( _p );
+                  const uint64_t bit = uint64_t(1) << ( depth % 64 );
+                  if( c == '{' )
+                     objects[depth / 64] |= bit;
+                  else
+                     objects[depth / 64] &= ~bit;
+                  ++depth;
+                  ++_p;
+                  return true;
+               }
+               // a NUL reads as null without being consumed, nothing can follow it
+               if( c == 0 )
+                  return fail( _p );
+               return relaxed_scalar( c );
+            }
+
+            bool relaxed_scalar( char c )
+            {
+               switch( c )
+               {
+                  case '"':
+                     return quoted_string( '"', true );
+                  case '-':
+                  case '+':
+                  case '.':
+                  case '0': case '1': case '2': case '3': case '4':
+                  case '5': case '6': case '7': case '8': case '9':
+                     return relaxed_word( true );
+                  default:
+                     if( is_letter( c ) || c == '_' || c == '/' )
+                        return relaxed_word( false );
+                     return fail( _p );
+               }
+            }
+
+            /** json_relaxed::stringFromStream() */
+            bool relaxed_key()
+            {
+               const char c = *_p;
+               switch( c )
+               {
+                  case '\'':
+                     if( _strict )
+                        return fail( _p );
+                     return quoted_string( c, true );
+                  case '"':
+                     return quoted_string( c, true );
+                  case 'r':
+                  case 'R':
+                     // raw strings, or an unquoted word that starts with r
+                     if( _strict || ++_p == _end )
+                        return fail( _p );
+                     if( *_p == '"' || *_p == '\'' )
+                        return quoted_string( *_p, false );
+                     skip_word();
+                     return true;
+                  default:
+                     if( !is_word_char( c ) || _strict )
+                        return fail( _p );
+                     skip_word();
+                     return true;
+               }
+            }
+
+            /** json_relaxed::quoteStringFromStream(), at the opening quote @a q */
+            bool quoted_string( char q, bool allow_escape )
+            {
+               if( ++_p == _end )
+                  return fail( _p );
+               if( *_p == q )
+               {
+                  if( ++_p == _end )
+                     return fail( _p );
+                  if( *_p != q )
+                     return true;
+                  if( _strict )
+                     return fail( _p );
+                  ++_p;
+                  // triple quoted, up to the next three quotes
+                  while( true )
+                  {
+                     if( _p == _end )
+                        return fail( _p );
+                     const char c = *_p;
+                     if( c == q )
+                     {
+                        if( ++_p == _end )
+                           return fail( _p );
+                        if( *_p != q )
+                           continue;
+                        if( ++_p == _end )
+                           return fail( _p );
+                        if( *_p != q )
+                           continue;
+                        ++_p;
+                        return true;
+                     }
+                     if( c == '\x04' )
+                        return fail( _p );
+                     if( allow_escape && c == '\\' && ++_p == _end )
+                        return fail( _p );
+                     ++_p;
+                  }
+               }
+               while( true )
+               {
+                  if( _p == _end )
+                     return fail( _p );
+                  const char c = *_p;
+                  if( c == q )
+                  {
+                     ++_p;
+                     return true;
+                  }
+                  if( c == '\x04' || c == '\r' || c == '\n' )
+                     return fail( _p );
+                  if( allow_escape && c == '\\' && ++_p == _end )
+                     return fail( _p );
+                  ++_p;
+               }
+            }
+
+            /**
+             *  json_relaxed::tokenFromStream(), which consumes the separator that ends the word.
+             *  @return the end of the word, before that separator
+             */
+            const char* skip_word( bool* escaped = nullptr )
+            {
+               while( _p != _end )
+               {
+                  const char c = *_p;
+                  if( c == '\\' )
+                  {
+                     if( escaped )
+                        *escaped = true;
+                     if( ++_p == _end )
+                        return _p;
+                     ++_p;
+                     continue;
+                  }
+                  if( c == '\t' || c == ' ' || c == ',' || c == ':' || c == '\0' || c == '\n' || c == '\x04' )
+                     return _p++;
+                  if( !is_word_char( c ) )
+                     return _p;
+                  ++_p;
+               }
+               return _p;
+            }
+
+            /** numberFromStream() if @a number, wordFromStream() otherwise */
+            bool relaxed_word( bool number )
+            {
+               const char* start = _p;
+               bool escaped = false;
+               const char* end = skip_word( &escaped );
+
+               const char* t = start;
+               size_t n = end - start;
+               char buffer[256];
+               std::string long_word;
+               if( escaped )
+               {
+                  // a backslash at the end of the input escapes nothing
+                  n = 0;
+                  for( const char* p = start; p != end; ++p )
+                  {
+                     if( *p == '\\' && ++p == end )
+                        break;
+                     ++n;
+                  }
+                  char* out = buffer;
+                  if( n > sizeof(buffer) )
+                  {
+                     long_word.resize( n );
+                     out = &long_word[0];
+                  }
+                  t = out;
+                  for( const char* p = start; p != end; )
+                  {
+                     if( *p != '\\' )
+                        *out++ = *p++;
+                     else if( ++p != end )
+                        *out++ = unescape( *p++ );
+                  }
+               }
+
+               if( number )
+                  return relaxed_number( t, n, _strict ) || fail( start );
+               if( ( n == 4 && memcmp( t, "null", 4 ) == 0 ) ||
+                   ( n == 4 && memcmp( t, "true", 4 ) == 0 ) ||
+                   ( n == 5 && memcmp( t, "false", 5 ) == 0 ) )
+                  return true;
+               return !_strict || fail( start );
+            }
+
+            const char*    _begin;
+            const char*    _p;
+            const char*    _end;
+            const bool     _strict;
+            size_t         _error = 0;
+      };
+   }
+
+   bool validate_relaxed( const char* data, size_t size, bool strict, size_t& error_offset )
+   {
+      if( size == 0 )
+      {
+         error_offset = 0;
+         return false;
+      }
+      return validator( data, size, strict ).validate( error_offset );
+   }
+
+} } // fc::json_validator
@@ -1,5 +1,6 @@
 #include <fc/rpc/json_connection.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/json_push_parser.hpp>
 #include <boost/unordered_map.hpp>
 #include <fc/thread/thread.hpp>
 #include <fc/thread/scoped_lock.hpp>
@@ -204,13 +205,15 @@ namespace fc { namespace rpc {
                fc::exception_ptr eptr;
                try 
                {
-                  fc::string line;
+                  // messages are parsed as their bytes arrive, not once they are complete
+                  json_push_parser parser;
                   while( !_done.canceled() )
                   {
-                      variant v = json::from_stream(*_in);
-                      ///ilog( "input: ${in}", ("in", v ) );
-                      //wlog(  "recv: ${line}", ("line", line) );
-                      _handle_message_future = fc::async([=](){ handle_message(v.get_object()); }, "json_connection handle_message");
+                      for( const variant& v : parser.feed( *_in ) )
+                      {
+                         ///ilog( "input: ${in}", ("in", v ) );
+                         _handle_message_future = fc::async([=](){ handle_message(v.get_object()); }, "json_connection handle_message");
+                      }
                   } 
                } 
                catch ( eof_exception& eof ) 
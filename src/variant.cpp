@@ -1,5 +1,6 @@
 #include <fc/variant.hpp>
 #include <fc/variant_object.hpp>
+#include <fc/variant_arena.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/io/sstream.hpp>
 #include <fc/io/json.hpp>
@@ -10,6 +11,7 @@
 #include <boost/scoped_array.hpp>
 #include <fc/reflect/variant.hpp>
 #include <algorithm>
+#include <atomic>
 
 namespace fc
 {
@@ -22,6 +24,165 @@ void set_variant_type( variant* v, variant::type_id t)
    data[ sizeof(variant) -1 ] = t;
 }
 
+using detail::variant_payload;
+
+/** allocates a payload from the variant_arena the thread is building a tree in if there is one */
+template<typename T, typename... Args>
+variant_payload<T>* new_payload( Args&&... args )
+{
+   variant_arena* arena = detail::current_variant_arena();
+   if( arena == nullptr )
+      return new variant_payload<T>( std::forward<Args>(args)... );
+
+   void* mem = arena->allocate( sizeof(variant_payload<T>) );
+   try
+   {
+      variant_payload<T>* p = new (mem) variant_payload<T>( std::forward<Args>(args)... );
+      p->arena = arena->blocks();
+      return p;
+   }
+   catch( ... )
+   {
+      detail::release_arena_allocation( arena->blocks() );
+      throw;
+   }
+}
+
+template<typename T>
+inline variant_payload<T>* get_payload( const variant* v )
+{
+   return *reinterpret_cast<variant_payload<T>* const*>(v);
+}
+
+template<typename T>
+inline const T& payload_value( const variant* v )
+{
+   return get_payload<T>( v )->value;
+}
+
+template<typename T>
+inline void set_payload( variant* v, variant_payload<T>* p, variant::type_id t )
+{
+   *reinterpret_cast<variant_payload<T>**>(v) = p;
+   set_variant_type( v, t );
+}
+
+template<typename T>
+void release_payload( variant* v )
+{
+   variant_payload<T>* p = get_payload<T>( v );
+   if( p->ref_count.fetch_sub( 1, std::memory_order_acq_rel ) != 1 )
+      return;
+   if( detail::arena_blocks* arena = p->arena )
+   {
+      p->~variant_payload<T>();
+      detail::release_arena_allocation( arena );
+   }
+   else
+      delete p;
+}
+
+/** @return a copy of @a value, the variants of an array are copied one by one */
+template<typename T>
+T copy_out_of_arena( const T& value )
+{
+   return value;
+}
+
+/** the copies of a variant_object share its entries, which are copied one by one instead */
+variant_object copy_out_of_arena( const variant_object& obj )
+{
+   return variant_object( mutable_variant_object( obj ) );
+}
+
+/**
+ *  makes @a dst refer to the payload of @a src, or to a copy of it when it is not shareable.
+ *  A payload of an arena is copied to the heap along with the payloads below it, copies of a
+ *  tree built in an arena are what is kept after the request, and must not keep the arena
+ *  from being freed.
+ */
+template<typename T>
+void copy_payload( variant* dst, const variant* src )
+{
+   variant_payload<T>* p = get_payload<T>( src );
+   if( p->arena )
+      set_payload( dst, new variant_payload<T>( copy_out_of_arena( p->value ) ), src->get_type() );
+   else if( p->shareable )
+   {
+      p->ref_count.fetch_add( 1, std::memory_order_relaxed );
+      memcpy( (char*)dst, (const char*)src, sizeof(variant) );
+   }
+   else
+      set_payload( dst, new_payload<T>( p->value ), src->get_type() );
+}
+
+/** @return the value held by @a v after making sure no other variant refers to it */
+template<typename T>
+T& mutable_payload_value( variant* v )
+{
+   variant_payload<T>* p = get_payload<T>( v );
+   if( p->ref_count.load( std::memory_order_acquire ) != 1 )
+   {
+      variant_payload<T>* copy = new_payload<T>( p->value );
+      release_payload<T>( v );
+      set_payload( v, copy, v->get_type() );
+      p = copy;
+   }
+   p->shareable = false;
+   return p->value;
+}
+
+/**
+ *  Strings of up to max_inline_string_size bytes are stored in the variant itself:
+ *  the characters start at the first byte, the length is kept in the byte in front
+ *  of the TypeID and the TypeID carries inline_string_flag.  Longer strings are
+ *  kept in a payload.
+ */
+using detail::inline_string_flag;
+const size_t  max_inline_string_size = sizeof(variant) - 2;
+
+inline bool is_inline_string( const variant* v )
+{
+   return reinterpret_cast<const uint8_t*>(v)[ sizeof(variant) -1 ] == (variant::string_type | inline_string_flag);
+}
+
+inline const char* inline_string_data( const variant* v )
+{
+   return reinterpret_cast<const char*>(v);
+}
+
+inline size_t inline_string_size( const variant* v )
+{
+   return reinterpret_cast<const uint8_t*>(v)[ sizeof(variant) -2 ];
+}
+
+void set_variant_string( variant* v, const char* str, size_t len )
+{
+   if( len <= max_inline_string_size )
+   {
+      uint8_t* data = reinterpret_cast<uint8_t*>(v);
+      memcpy( data, str, len );
+      data[ sizeof(variant) -2 ] = uint8_t(len);
+      data[ sizeof(variant) -1 ] = variant::string_type | inline_string_flag;
+   }
+   else
+      set_payload( v, new_payload<string>( str, len ), variant::string_type );
+}
+
+/**
+ *  Returns the string held by @a v, inline strings are copied into @a tmp which
+ *  is small enough to not require an allocation.
+ */
+inline const string& variant_string( const variant* v, string& tmp )
+{
+   if( is_inline_string( v ) )
+   {
+      tmp.assign( inline_string_data( v ), inline_string_size( v ) );
+      return tmp;
+   }
+   return payload_value<string>( v );
+}
+
 variant::variant()
 {
    set_variant_type( this, null_type );
@@ -100,14 +261,12 @@ variant::variant( bool val )
 
 variant::variant( char* str )
 {
-   *reinterpret_cast<string**>(this)  = new string( str );
-   set_variant_type( this, string_type );
+   set_variant_string( this, str, strlen( str ) );
 }
 
 variant::variant( const char* str )
 {
-   *reinterpret_cast<string**>(this)  = new string( str );
-   set_variant_type( this, string_type );
+   set_variant_string( this, str, strlen( str ) );
 }
 
 // TODO: do a proper conversion to utf8
@@ -117,8 +276,7 @@ variant::variant( wchar_t* str )
    boost::scoped_array<char> buffer(new char[len]);
    for (unsigned i = 0; i < len; ++i)
      buffer[i] = (char)str[i];
-   *reinterpret_cast<string**>(this)  = new string(buffer.get(), len);
-   set_variant_type( this, string_type );
+   set_variant_string( this, buffer.get(), len );
 }
 
 // TODO: do a proper conversion to utf8
@@ -128,56 +286,54 @@ variant::variant( const wchar_t* str )
    boost::scoped_array<char> buffer(new char[len]);
    for (unsigned i = 0; i < len; ++i)
      buffer[i] = (char)str[i];
-   *reinterpret_cast<string**>(this)  = new string(buffer.get(), len);
-   set_variant_type( this, string_type );
+   set_variant_string( this, buffer.get(), len );
 }
 
 variant::variant( fc::string val )
 {
-   *reinterpret_cast<string**>(this)  = new string( fc::move(val) );
-   set_variant_type( this, string_type );
+   if( val.size() <= max_inline_string_size )
+   {
+      set_variant_string( this, val.data(), val.size() );
+      return;
+   }
+   set_payload( this, new_payload<string>( fc::move(val) ), string_type );
 }
 variant::variant( blob val )
 {
-   *reinterpret_cast<blob**>(this)  = new blob( fc::move(val) );
-   set_variant_type( this, blob_type );
+   set_payload( this, new_payload<blob>( fc::move(val) ), blob_type );
 }
 
 variant::variant( variant_object obj)
 {
-   *reinterpret_cast<variant_object**>(this)  = new variant_object(fc::move(obj));
-   set_variant_type(this,  object_type );
+   set_payload( this, new_payload<variant_object>( fc::move(obj) ), object_type );
 }
 variant::variant( mutable_variant_object obj)
 {
-   *reinterpret_cast<variant_object**>(this)  = new variant_object(fc::move(obj));
-   set_variant_type(this,  object_type );
+   set_payload( this, new_payload<variant_object>( fc::move(obj) ), object_type );
 }
 
 variant::variant( variants arr )
 {
-   *reinterpret_cast<variants**>(this)  = new variants(fc::move(arr));
-   set_variant_type(this,  array_type );
+   set_payload( this, new_payload<variants>( fc::move(arr) ), array_type );
 }
 
 
-typedef const variant_object* const_variant_object_ptr; 
-typedef const variants* const_variants_ptr; 
-typedef const blob*   const_blob_ptr; 
-typedef const string* const_string_ptr;
-
 void variant::clear()
 {
    switch( get_type() )
    {
      case object_type:
-        delete *reinterpret_cast<variant_object**>(this);
+        release_payload<variant_object>( this );
         break;
      case array_type:
-        delete *reinterpret_cast<variants**>(this);
+        release_payload<variants>( this );
         break;
      case string_type:
-        delete *reinterpret_cast<string**>(this);
+        if( !is_inline_string( this ) )
+           release_payload<string>( this );
+        break;
+     case blob_type:
+        release_payload<blob>( this );
         break;
      default:
         break;
@@ -190,23 +346,23 @@ variant::variant( const variant& v )
    switch( v.get_type() )
    {
        case object_type:
-          *reinterpret_cast<variant_object**>(this)  = 
-             new variant_object(**reinterpret_cast<const const_variant_object_ptr*>(&v));
-          set_variant_type( this, object_type );
+          copy_payload<variant_object>( this, &v );
           return;
        case array_type:
-          *reinterpret_cast<variants**>(this)  = 
-             new variants(**reinterpret_cast<const const_variants_ptr*>(&v));
-          set_variant_type( this,  array_type );
+          copy_payload<variants>( this, &v );
           return;
        case string_type:
-          *reinterpret_cast<string**>(this)  = 
-             new string(**reinterpret_cast<const const_string_ptr*>(&v) );
-          set_variant_type( this, string_type );
+          if( is_inline_string( &v ) )
+             break;
+          copy_payload<string>( this, &v );
+          return;
+       case blob_type:
+          copy_payload<blob>( this, &v );
           return;
        default:
-          memcpy( this, &v, sizeof(v) );
+          break;
    }
+   memcpy( this, &v, sizeof(v) );
 }
 
 variant::variant( variant&& v )
@@ -223,9 +379,12 @@ variant::~variant()
 variant& variant::operator=( variant&& v )
 {
    if( this == &v ) return *this;
-   clear();
-   memcpy( (char*)this, (char*)&v, sizeof(v) );
+   // v may be owned by our current value, take it over before releasing that
+   char tmp[sizeof(variant)];
+   memcpy( tmp, (char*)&v, sizeof(v) );
    set_variant_type( &v, null_type ); 
+   clear();
+   memcpy( (char*)this, tmp, sizeof(v) );
    return *this;
 }
 
@@ -234,26 +393,8 @@ variant& variant::operator=( const variant& v )
    if( this == &v ) 
       return *this;
 
-   clear();
-   switch( v.get_type() )
-   {
-      case object_type:
-         *reinterpret_cast<variant_object**>(this)  = 
-            new variant_object((**reinterpret_cast<const const_variant_object_ptr*>(&v)));
-         break;
-      case array_type:
-         *reinterpret_cast<variants**>(this)  = 
-            new variants((**reinterpret_cast<const const_variants_ptr*>(&v)));
-         break;
-      case string_type:
-         *reinterpret_cast<string**>(this)  = new string((**reinterpret_cast<const const_string_ptr*>(&v)) );
-         break;
-
-      default:
-         memcpy( this, &v, sizeof(v) );
-   }
-   set_variant_type( this, v.get_type() );
-   return *this;
+   // v may be owned by our current value, so copy it before releasing that
+   return *this = variant( v );
 }
 
 void  variant::visit( const visitor& v )const
@@ -276,24 +417,22 @@ void  variant::visit( const visitor& v )const
          v.handle( *reinterpret_cast<const bool*>(this) );
          return;
       case string_type:
-         v.handle( **reinterpret_cast<const const_string_ptr*>(this) );
+      {
+         string tmp;
+         v.handle( variant_string( this, tmp ) );
          return;
+      }
       case array_type:
-         v.handle( **reinterpret_cast<const const_variants_ptr*>(this) );
+         v.handle( payload_value<variants>( this ) );
          return;
       case object_type:
-         v.handle( **reinterpret_cast<const const_variant_object_ptr*>(this) );
+         v.handle( payload_value<variant_object>( this ) );
          return;
       default:
          FC_THROW_EXCEPTION( assert_exception, "Invalid Type / Corrupted Memory" );
    }
 }
 
-variant::type_id variant::get_type()const
-{
-   return (type_id)reinterpret_cast<const char*>(this)[sizeof(*this)-1];
-}
-
 bool variant::is_null()const
 {
    return get_type() == null_type;
@@ -367,7 +506,10 @@ int64_t variant::as_int64()const
    switch( get_type() )
    {
       case string_type:
-          return to_int64(**reinterpret_cast<const const_string_ptr*>(this)); 
+      {
+          string tmp;
+          return to_int64( variant_string( this, tmp ) );
+      }
       case double_type:
           return int64_t(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -388,7 +530,10 @@ uint64_t variant::as_uint64()const
    switch( get_type() )
    {
       case string_type:
-          return to_uint64(**reinterpret_cast<const const_string_ptr*>(this)); 
+      {
+          string tmp;
+          return to_uint64( variant_string( this, tmp ) );
+      }
       case double_type:
           return static_cast<uint64_t>(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -410,7 +555,10 @@ double  variant::as_double()const
    switch( get_type() )
    {
       case string_type:
-          return to_double(**reinterpret_cast<const const_string_ptr*>(this)); 
+      {
+          string tmp;
+          return to_double( variant_string( this, tmp ) );
+      }
       case double_type:
           return *reinterpret_cast<const double*>(this);
       case int64_type:
@@ -432,7 +580,8 @@ bool  variant::as_bool()const
    {
       case string_type:
       {
-          const string& s = **reinterpret_cast<const const_string_ptr*>(this);
+          string tmp;
+          const string& s = variant_string( this, tmp );
           if( s == "true" )
              return true;
           if( s == "false" )
@@ -459,7 +608,9 @@ string    variant::as_string()const
    switch( get_type() )
    {
       case string_type:
-          return **reinterpret_cast<const const_string_ptr*>(this); 
+          if( is_inline_string( this ) )
+             return string( inline_string_data( this ), inline_string_size( this ) );
+          return payload_value<string>( this ); 
       case double_type:
           return to_string(*reinterpret_cast<const double*>(this)); 
       case int64_type:
@@ -484,21 +635,21 @@ string    variant::as_string()const
 variants&         variant::get_array()
 {
   if( get_type() == array_type )
-     return **reinterpret_cast<variants**>(this);
+     return mutable_payload_value<variants>( this );
    
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Array", ("type",get_type()) );
 }
 blob&         variant::get_blob()
 {
   if( get_type() == blob_type )
-     return **reinterpret_cast<blob**>(this);
+     return mutable_payload_value<blob>( this );
    
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Blob", ("type",get_type()) );
 }
 const blob&         variant::get_blob()const
 {
   if( get_type() == blob_type )
-     return **reinterpret_cast<const const_blob_ptr*>(this);
+     return payload_value<blob>( this );
    
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Blob", ("type",get_type()) );
 }
@@ -511,11 +662,12 @@ blob variant::as_blob()const
       case blob_type: return get_blob();
       case string_type:
       {
-         const string& str = get_string();
+         string tmp;
+         const string& str = variant_string( this, tmp );
          if( str.size() == 0 ) return blob();
          if( str.back() == '=' )
          {
-            std::string b64 = base64_decode( get_string() );
+            std::string b64 = base64_decode( str );
             return blob( { std::vector<char>( b64.begin(), b64.end() ) } );
          }
          return blob( { std::vector<char>( str.begin(), str.end() ) } );
@@ -533,7 +685,7 @@ blob variant::as_blob()const
 const variants&       variant::get_array()const
 {
   if( get_type() == array_type )
-     return **reinterpret_cast<const const_variants_ptr*>(this);
+     return payload_value<variants>( this );
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Array", ("type",get_type()) );
 }
 
@@ -542,7 +694,7 @@ const variants&       variant::get_array()const
 variant_object&        variant::get_object()
 {
   if( get_type() == object_type )
-     return **reinterpret_cast<variant_object**>(this);
+     return mutable_payload_value<variant_object>( this );
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Object", ("type",get_type()) );
 }
 
@@ -562,16 +714,54 @@ size_t            variant::size()const
 
 const string&        variant::get_string()const
 {
+  if( is_inline_string( this ) )
+  {
+     // a short string stored inline has no fc::string to refer to, it is moved to a payload of
+     // its own once, which is returned from then on like the string of any other variant
+     variant_payload<string>* p = new variant_payload<string>( inline_string_data( this ), inline_string_size( this ) );
+     set_payload( const_cast<variant*>( this ), p, string_type );
+     return p->value;
+  }
   if( get_type() == string_type )
-     return **reinterpret_cast<const const_string_ptr*>(this);
-  FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to Object", ("type",get_type()) );
+     return payload_value<string>( this );
+  FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to String", ("type",get_type()) );
+}
+
+const string&        variant::string_value( string& tmp )const
+{
+  if( get_type() == string_type )
+     return variant_string( this, tmp );
+  FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to String", ("type",get_type()) );
+}
+
+void                 variant::throw_invalid_type()const
+{
+   FC_THROW_EXCEPTION( assert_exception, "Invalid Type / Corrupted Memory" );
+}
+
+const char*          variant::string_data()const
+{
+  if( is_inline_string( this ) )
+     return inline_string_data( this );
+  if( get_type() == string_type )
+     return payload_value<string>( this ).data();
+  FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to String", ("type",get_type()) );
+}
+
+size_t               variant::string_size()const
+{
+  if( is_inline_string( this ) )
+     return inline_string_size( this );
+  if( get_type() == string_type )
+     return payload_value<string>( this ).size();
+  FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to String", ("type",get_type()) );
 }
 
 /// @throw if get_type() != object_type 
 const variant_object&  variant::get_object()const
 {
   if( get_type() == object_type )
-     return **reinterpret_cast<const const_variant_object_ptr*>(this);
+     return payload_value<variant_object>( this );
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to Object", ("type",get_type()) );
 }
 
@@ -0,0 +1,98 @@
+#include <fc/variant_arena.hpp>
+#include <atomic>
+#include <stdlib.h>
+#include <new>
+#include <vector>
+
+namespace fc
+{
+   namespace detail
+   {
+      /**
+       *  The memory of an arena.  pending starts far above any number of allocations and
+       *  goes down by one for each allocation given back; the arena takes the bias out
+       *  again when it is destroyed, so whoever brings pending to zero frees the blocks.
+       */
+      struct arena_blocks
+      {
+         static const int64_t bias = int64_t(1) << 62;
+
+         std::vector<char*>    blocks;
+         std::atomic<int64_t>  pending{ bias };
+
+         ~arena_blocks()
+         {
+            for( char* block : blocks )
+               free( block );
+         }
+      };
+
+      void release_arena_allocation( arena_blocks* b )
+      {
+         if( b->pending.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+            delete b;
+      }
+
+      static thread_local variant_arena* current_arena = nullptr;
+
+      variant_arena* current_variant_arena()
+      {
+         return current_arena;
+      }
+
+      variant_arena_scope::variant_arena_scope( variant_arena& a )
+      :_previous(current_arena)
+      {
+         current_arena = &a;
+      }
+
+      variant_arena_scope::~variant_arena_scope()
+      {
+         current_arena = _previous;
+      }
+   }
+
+   const size_t arena_alignment = alignof(std::max_align_t);
+
+   variant_arena::variant_arena( size_t block_size )
+   :_block_size(block_size),_pos(nullptr),_end(nullptr),_allocated(0),_allocations(0),_blocks(new detail::arena_blocks)
+   {
+   }
+
+   variant_arena::~variant_arena()
+   {
+      // payloads that are still alive keep the blocks until the last of them is released
+      const int64_t outstanding = _blocks->pending.fetch_add( int64_t(_allocations) - detail::arena_blocks::bias,
+                                                              std::memory_order_acq_rel );
+      if( outstanding + int64_t(_allocations) - detail::arena_blocks::bias == 0 )
+         delete _blocks;
+   }
+
+   void* variant_arena::allocate( size_t size )
+   {
+      size = (size + arena_alignment - 1) & ~(arena_alignment - 1);
+      if( size > size_t(_end - _pos) )
+      {
+         // oversized requests get a block of their own so the current one keeps its free space
+         const size_t block_size = size > _block_size / 4 ? size : _block_size;
+         char* block = static_cast<char*>( malloc( block_size ) );
+         if( block == nullptr )
+            throw std::bad_alloc();
+         _blocks->blocks.push_back( block );
+         if( block_size != _block_size )
+         {
+            _allocated += size;
+            ++_allocations;
+            return block;
+         }
+         _pos = block;
+         _end = block + block_size;
+      }
+      void* result = _pos;
+      _pos += size;
+      _allocated += size;
+      ++_allocations;
+      return result;
+   }
+
+} // namespace fc
@@ -0,0 +1,107 @@
+#include <fc/variant_limits.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/exception/exception.hpp>
+
+namespace fc
+{
+   static thread_local parse_budget* current_budget = nullptr;
+
+   /** the vector of a variant_object and the control block it shares with its copies */
+   const size_t object_entries_overhead = sizeof(std::vector<variant_object::entry>) + 2 * sizeof(void*);
+
+   /** short strings live in the small string buffer */
+   static size_t heap_string_size( size_t length )
+   {
+      return length > string().capacity() ? length + 1 : 0;
+   }
+
+   /** entries and keys of @a o, without the variant_object and the values */
+   static size_t object_heap_size( const variant_object& o )
+   {
+      size_t size = object_entries_overhead + o.size() * sizeof(variant_object::entry);
+      for( const auto& e : o )
+         size += heap_string_size( e.key().size() );
+      return size;
+   }
+
+   size_t estimated_node_size( const variant& v )
+   {
+      switch( v.get_type() )
+      {
+         case variant::string_type:
+         {
+            const char* data = v.string_data();
+            if( data >= reinterpret_cast<const char*>( &v ) && data < reinterpret_cast<const char*>( &v + 1 ) )
+               return 0;
+            return sizeof(detail::variant_payload<string>) + heap_string_size( v.string_size() );
+         }
+         case variant::blob_type:
+            return sizeof(detail::variant_payload<blob>) + v.get_blob().data.capacity();
+         case variant::array_type:
+            return sizeof(detail::variant_payload<variants>) + v.get_array().capacity() * sizeof(variant);
+         case variant::object_type:
+            return sizeof(detail::variant_payload<variant_object>) + object_heap_size( v.get_object() );
+         default:
+            return 0;
+      }
+   }
+
+   size_t estimated_size( const variant& v )
+   {
+      size_t size = sizeof(variant);
+      walk_variant( v, [&]( const variant& node, uint32_t )
+      {
+         size += estimated_node_size( node );
+      });
+      return size;
+   }
+
+   size_t estimated_size( const variant_object& o )
+   {
+      size_t size = sizeof(variant_object) + object_heap_size( o );
+      for( const auto& e : o )
+         size += estimated_size( e.value() ) - sizeof(variant);
+      return size;
+   }
+
+   size_t estimated_size( const variants& a )
+   {
+      size_t size = sizeof(variants) + a.capacity() * sizeof(variant);
+      for( const auto& item : a )
+         size += estimated_size( item ) - sizeof(variant);
+      return size;
+   }
+
+   // ---------------------------------------------------------------
+   // parse_budget
+
+   parse_budget::parse_budget( const parse_limits& limits )
+   :_limits(limits),_bytes(sizeof(variant)),_previous(current_budget)
+   {
+      current_budget = this;
+   }
+
+   parse_budget::~parse_budget()
+   {
+      current_budget = _previous;
+   }
+
+   parse_budget* parse_budget::current()
+   {
+      return current_budget;
+   }
+
+   void parse_budget::exceeded( size_t more )const
+   {
+      FC_ASSERT( _depth <= _limits.max_depth, "variant nested too deeply", ("max_depth", _limits.max_depth) );
+      FC_ASSERT( _nodes <= _limits.max_nodes, "variant has too many nodes", ("max_nodes", _limits.max_nodes) );
+      FC_THROW_EXCEPTION( assert_exception, "variant is too large",
+                          ("bytes", uint64_t(_bytes + more))("max_bytes", uint64_t(_limits.max_bytes)) );
+   }
+
+   void parse_budget::too_deep()const
+   {
+      FC_THROW_EXCEPTION( assert_exception, "variant nested too deeply", ("max_depth", _limits.max_depth) );
+   }
+
+} // namespace fc
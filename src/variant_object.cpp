@@ -1,22 +1,155 @@
 #include <fc/variant_object.hpp>
 #include <fc/exception/exception.hpp>
+#include <fc/crypto/city.hpp>
 #include <assert.h>
+#include <string.h>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 
 namespace fc
 {
+   namespace detail
+   {
+      /**
+       *  Open addressing hash table over the positions of the entries of an object.
+       *  Only the first of several entries with the same key is indexed so lookups
+       *  return the same entry a linear scan would.
+       *
+       *  Entries is the std::vector of a variant_object or the small_vector of a
+       *  mutable_variant_object.
+       */
+      class key_index
+      {
+         public:
+            typedef variant_object::entry entry;
+
+            template<typename Entries>
+            explicit key_index( const Entries& entries )
+            {
+               rehash( entries );
+            }
+
+            /** number of leading entries covered by the index */
+            size_t size()const { return _size; }
+
+            /** @return the position of @a key or entries.size() if not found */
+            template<typename Entries>
+            size_t find( const Entries& entries, const char* key, size_t len )const
+            {
+               const size_t mask = _slots.size() - 1;
+               for( size_t slot = city_hash_size_t( key, len ) & mask; _slots[slot] != 0; slot = (slot + 1) & mask )
+               {
+                  const string& k = entries[_slots[slot] - 1].key();
+                  if( k.size() == len && memcmp( k.data(), key, len ) == 0 )
+                     return _slots[slot] - 1;
+               }
+               return entries.size();
+            }
+
+            /** indexes entries.back(), which must be the only entry added since the last call */
+            template<typename Entries>
+            void add( const Entries& entries )
+            {
+               assert( entries.size() == _size + 1 );
+               if( entries.size() * 2 > _slots.size() )
+                  rehash( entries );
+               else
+                  insert( entries, _size++ );
+            }
+
+         private:
+            template<typename Entries>
+            void rehash( const Entries& entries )
+            {
+               size_t capacity = 16;
+               while( capacity < entries.size() * 2 )
+                  capacity <<= 1;
+               _slots.assign( capacity, 0 );
+               for( _size = 0; _size < entries.size(); ++_size )
+                  insert( entries, _size );
+            }
+
+            template<typename Entries>
+            void insert( const Entries& entries, size_t pos )
+            {
+               const string& key = entries[pos].key();
+               const size_t mask = _slots.size() - 1;
+               size_t slot = city_hash_size_t( key.data(), key.size() ) & mask;
+               for( ; _slots[slot] != 0; slot = (slot + 1) & mask )
+                  if( entries[_slots[slot] - 1].key() == key )
+                     return;
+               _slots[slot] = uint32_t(pos + 1);
+            }
+
+            std::vector<uint32_t> _slots; ///< entry position + 1, 0 marks an empty slot
+            size_t                _size;
+      };
+   }
+
+   /** objects with fewer entries are searched linearly */
+   const size_t min_indexed_size = 16;
+
+   template<typename Entries>
+   static size_t scan_entries( const Entries& entries, const char* key, size_t len )
+   {
+      for( size_t i = 0; i < entries.size(); ++i )
+      {
+         const string& k = entries[i].key();
+         if( k.size() == len && memcmp( k.data(), key, len ) == 0 )
+            return i;
+      }
+      return entries.size();
+   }
    // ---------------------------------------------------------------
    // entry
 
+   /** static keys that fit in the small string buffer are cheaper to copy than to intern */
+   static const size_t max_copied_static_key = string().capacity();
+
+   /**
+    *  Static keys are interned by their text in a table shared by all threads, each
+    *  thread caches the result by address so repeated lookups need neither the
+    *  lock nor a hash of the text.  Interned keys are never released.
+    */
+   static const string* intern_static_key( const char* key, size_t len )
+   {
+      static thread_local std::unordered_map<const char*, const string*> cache;
+      auto itr = cache.find( key );
+      if( itr != cache.end() )
+         return itr->second;
+
+      static std::mutex                 table_mutex;
+      static std::unordered_set<string> table;
+      const string* interned;
+      {
+         std::lock_guard<std::mutex> lock( table_mutex );
+         interned = &*table.emplace( key, len ).first;
+      }
+      cache.emplace( key, interned );
+      return interned;
+   }
+
    variant_object::entry::entry() {}
    variant_object::entry::entry( string k, variant v ) : _key(fc::move(k)),_value(fc::move(v)) {}
-   variant_object::entry::entry( entry&& e ) : _key(fc::move(e._key)),_value(fc::move(e._value)) {}
-   variant_object::entry::entry( const entry& e ) : _key(e._key),_value(e._value) {}
+   variant_object::entry::entry( static_key k, variant v ) : _value(fc::move(v))
+   {
+      const size_t len = strlen( k.str );
+      if( len <= max_copied_static_key )
+         _key.assign( k.str, len );
+      else
+         _interned_key = intern_static_key( k.str, len );
+   }
+   variant_object::entry::entry( entry&& e ) : _key(fc::move(e._key)),_interned_key(e._interned_key),_value(fc::move(e._value)) {}
+   variant_object::entry::entry( const entry& e ) : _key(e._key),_interned_key(e._interned_key),_value(e._value) {}
    variant_object::entry& variant_object::entry::operator=( const variant_object::entry& e )
    {
       if( this != &e ) 
       {
          _key = e._key;
+         _interned_key = e._interned_key;
          _value = e._value;
       }
       return *this;
@@ -24,13 +157,14 @@ namespace fc
    variant_object::entry& variant_object::entry::operator=( variant_object::entry&& e )
    {
       fc_swap( _key, e._key );
+      fc_swap( _interned_key, e._interned_key );
       fc_swap( _value, e._value );
       return *this;
    }
    
    const string&        variant_object::entry::key()const
    {
-      return _key;
+      return _interned_key ? *_interned_key : _key;
    }
 
    const variant& variant_object::entry::value()const
@@ -61,21 +195,37 @@ namespace fc
       return _key_value->end();
    }
 
+   /**
+    *  The index is built on the first lookup, which may be a const one, so it is published
+    *  with atomic_store and concurrent readers of the same object either see it complete or
+    *  build their own.  The entries of a variant_object are never modified in place, so once
+    *  built the index is immutable and may be shared by every copy of the object.  The index
+    *  of a mutable_variant_object is owned by it and kept current by append().
+    */
+   template<typename Entries>
+   static size_t find_entry( const Entries& entries,
+                             std::shared_ptr<detail::key_index>& index, const char* key, size_t len )
+   {
+      if( entries.size() < min_indexed_size )
+         return scan_entries( entries, key, len );
+
+      auto idx = std::atomic_load( &index );
+      if( !idx || idx->size() != entries.size() )
+      {
+         idx = std::make_shared<detail::key_index>( entries );
+         std::atomic_store( &index, idx );
+      }
+      return idx->find( entries, key, len );
+   }
+
    variant_object::iterator variant_object::find( const string& key )const
    {
-      return find( key.c_str() );
+      return begin() + find_entry( *_key_value, _index, key.data(), key.size() );
    }
 
    variant_object::iterator variant_object::find( const char* key )const
    {
-      for( auto itr = begin(); itr != end(); ++itr )
-      {
-         if( itr->key() == key )
-         {
-            return itr;
-         }
-      }
-      return end();
+      return begin() + find_entry( *_key_value, _index, key, strlen( key ) );
    }
 
    const variant& variant_object::operator[]( const string& key )const
@@ -108,27 +258,35 @@ namespace fc
    }
 
    variant_object::variant_object( const variant_object& obj )
-   :_key_value( obj._key_value )
+   :_key_value( obj._key_value ), _index( std::atomic_load( &obj._index ) )
    {
       assert( _key_value != nullptr );
    }
 
    variant_object::variant_object( variant_object&& obj)
-   : _key_value( fc::move(obj._key_value) )
+   : _key_value( fc::move(obj._key_value) ), _index( fc::move(obj._index) )
    {
       obj._key_value = std::make_shared<std::vector<entry>>();
       assert( _key_value != nullptr );
    }
 
    variant_object::variant_object( const mutable_variant_object& obj )
-      : _key_value(std::make_shared<std::vector<entry>>(*obj._key_value))
+      : _key_value(std::make_shared<std::vector<entry>>(obj._key_value.begin(), obj._key_value.end()))
    {
    }
 
+   /** the entries are moved into the shared vector, positions and thus the index stay valid */
+   static std::shared_ptr<std::vector<variant_object::entry>> take_entries( mutable_variant_object::entries& entries )
+   {
+      auto result = std::make_shared<std::vector<variant_object::entry>>( std::make_move_iterator( entries.begin() ),
+                                                                           std::make_move_iterator( entries.end() ) );
+      entries.clear();
+      return result;
+   }
+
    variant_object::variant_object( mutable_variant_object&& obj )
-   : _key_value(fc::move(obj._key_value))
+   : _key_value(take_entries(obj._key_value)), _index(fc::move(obj._index))
    {
-      assert( _key_value != nullptr );
    }
 
    variant_object& variant_object::operator=( variant_object&& obj )
@@ -136,6 +294,7 @@ namespace fc
       if (this != &obj)
       {
          fc_swap(_key_value, obj._key_value );
+         fc_swap(_index, obj._index );
          assert( _key_value != nullptr );
       }
       return *this;
@@ -146,20 +305,23 @@ namespace fc
       if (this != &obj)
       {
          _key_value = obj._key_value;
+         _index = std::atomic_load( &obj._index );
       }
       return *this;
    }
 
    variant_object& variant_object::operator=( mutable_variant_object&& obj )
    {
-      _key_value = fc::move(obj._key_value);
-      obj._key_value.reset( new std::vector<entry>() );
+      _key_value = take_entries(obj._key_value);
+      _index = fc::move(obj._index);
       return *this;
    }
 
    variant_object& variant_object::operator=( const mutable_variant_object& obj )
    {
-      *_key_value = *obj._key_value;
+      // other copies may share the current entries, so they are replaced rather than overwritten
+      _key_value = std::make_shared<std::vector<entry>>( obj._key_value.begin(), obj._key_value.end() );
+      _index.reset();
       return *this;
    }
 
@@ -179,56 +341,49 @@ namespace fc
 
    mutable_variant_object::iterator mutable_variant_object::begin()
    {
-      return _key_value->begin();
+      return _key_value.begin();
    }
 
    mutable_variant_object::iterator mutable_variant_object::end() 
    {
-      return _key_value->end();
+      return _key_value.end();
    }
 
    mutable_variant_object::iterator mutable_variant_object::begin() const
    {
-      return _key_value->begin();
+      return _key_value.begin();
    }
 
    mutable_variant_object::iterator mutable_variant_object::end() const
    {
-      return _key_value->end();
+      return _key_value.end();
    }
 
    mutable_variant_object::iterator mutable_variant_object::find( const string& key )const
    {
-      return find( key.c_str() );
+      return begin() + find_entry( _key_value, _index, key.data(), key.size() );
    }
 
    mutable_variant_object::iterator mutable_variant_object::find( const char* key )const
    {
-      for( auto itr = begin(); itr != end(); ++itr )
-      {
-         if( itr->key() == key )
-         {
-            return itr;
-         }
-      }
-      return end();
+      return begin() + find_entry( _key_value, _index, key, strlen( key ) );
    }
 
    mutable_variant_object::iterator mutable_variant_object::find( const string& key )
    {
-      return find( key.c_str() );
+      return begin() + find_entry( _key_value, _index, key.data(), key.size() );
    }
 
    mutable_variant_object::iterator mutable_variant_object::find( const char* key )
    {
-      for( auto itr = begin(); itr != end(); ++itr )
-      {
-         if( itr->key() == key )
-         {
-            return itr;
-         }
-      }
-      return end();
+      return begin() + find_entry( _key_value, _index, key, strlen( key ) );
+   }
+
+   void mutable_variant_object::append( entry&& e )
+   {
+      _key_value.push_back( fc::move(e) );
+      if( _index )
+         _index->add( _key_value );
    }
 
    const variant& mutable_variant_object::operator[]( const string& key )const
@@ -251,44 +406,44 @@ namespace fc
    {
       auto itr = find( key );
       if( itr != end() ) return itr->value();
-      _key_value->emplace_back(entry(key, variant()));
-      return _key_value->back().value();
+      append( entry( key, variant() ) );
+      return _key_value.back().value();
    }
 
    size_t mutable_variant_object::size() const
    {
-      return _key_value->size();
+      return _key_value.size();
    }
 
    mutable_variant_object::mutable_variant_object() 
-      :_key_value(new std::vector<entry>)
    {
    }
 
    mutable_variant_object::mutable_variant_object( string key, variant val )
-      : _key_value(new std::vector<entry>())
    {
-       _key_value->push_back(entry(fc::move(key), fc::move(val)));
+       _key_value.push_back(entry(fc::move(key), fc::move(val)));
    }
 
    mutable_variant_object::mutable_variant_object( const variant_object& obj )
-      : _key_value( new std::vector<entry>(*obj._key_value) )
+      : _key_value( obj._key_value->begin(), obj._key_value->end() )
    {
    }
 
    mutable_variant_object::mutable_variant_object( const mutable_variant_object& obj )
-      : _key_value( new std::vector<entry>(*obj._key_value) )
+      : _key_value( obj._key_value )
    {
    }
 
    mutable_variant_object::mutable_variant_object( mutable_variant_object&& obj )
-      : _key_value(fc::move(obj._key_value))
+      : _key_value(fc::move(obj._key_value)), _index(fc::move(obj._index))
    {
+      obj._key_value.clear();
    }
 
    mutable_variant_object& mutable_variant_object::operator=( const variant_object& obj )
    {
-      *_key_value = *obj._key_value;
+      _key_value.assign( obj._key_value->begin(), obj._key_value->end() );
+      _index.reset();
       return *this;
    }
 
@@ -297,6 +452,8 @@ namespace fc
       if (this != &obj)
       {
          _key_value = fc::move(obj._key_value);
+         _index = fc::move(obj._index);
+         obj._key_value.clear();
       }
       return *this;
    }
@@ -305,14 +462,15 @@ namespace fc
    {
       if (this != &obj)
       {
-         *_key_value = *obj._key_value;
+         _key_value = obj._key_value;
+         _index.reset();
       }
       return *this;
    }
 
    void mutable_variant_object::reserve( size_t s )
    {
-      _key_value->reserve(s);
+      _key_value.reserve(s);
    }
 
    void  mutable_variant_object::erase( const string& key )
@@ -321,7 +479,8 @@ namespace fc
       {
          if( itr->key() == key )
          {
-            _key_value->erase(itr);
+            _key_value.erase(itr);
+            _index.reset();
             return;
          }
       }
@@ -337,7 +496,21 @@ namespace fc
       }
       else
       {
-         _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+         append( entry( fc::move(key), fc::move(var) ) );
+      }
+      return *this;
+   }
+
+   mutable_variant_object& mutable_variant_object::set( static_key key, variant var )
+   {
+      auto itr = find( key.str );
+      if( itr != end() )
+      {
+         itr->set( fc::move(var) );
+      }
+      else
+      {
+         append( entry( key, fc::move(var) ) );
       }
       return *this;
    }
@@ -345,20 +518,20 @@ namespace fc
    /** Appends \a key and \a var without checking for duplicates, designed to
     *  simplify construction of dictionaries using (key,val)(key2,val2) syntax 
     */
-   mutable_variant_object& mutable_variant_object::operator()( string key, variant var )
+   mutable_variant_object& mutable_variant_object::operator()( string key, variant var ) &
    {
-      _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+      append( entry( fc::move(key), fc::move(var) ) );
       return *this;
    }
 
-   mutable_variant_object& mutable_variant_object::operator()( const variant_object& vo )
+   mutable_variant_object& mutable_variant_object::operator()( const variant_object& vo ) &
    {
       for( const variant_object::entry& e : vo )
          set( e.key(), e.value() );
       return *this;
    }
 
-   mutable_variant_object& mutable_variant_object::operator()( const mutable_variant_object& mvo )
+   mutable_variant_object& mutable_variant_object::operator()( const mutable_variant_object& mvo ) &
    {
       if( &mvo == this )     // mvo(mvo) is no-op
          return *this;
@@ -0,0 +1,111 @@
+/**
+ *  Reports the throughput of json::from_string for the legacy and the structural parser, of the
+ *  structural index alone, of json::is_valid, of json_push_parser fed in 4 KB chunks, of
+ *  json_subtree_reader reading the elements of the document one at a time, of json_extractor
+ *  finding a field of the first and of the last element, of json::to_string, serial and in parallel,
+ *  and of NDJSON written and read, one element per line, on a document shaped like API responses.
+ */
+#include <fc/variant.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/io/json.hpp>
+#include <fc/io/json_structural.hpp>
+#include <fc/io/json_extractor.hpp>
+#include <fc/io/json_push_parser.hpp>
+#include <fc/io/json_sax.hpp>
+#include <fc/io/sstream.hpp>
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+   std::string make_document( uint32_t entries )
+   {
+      fc::variants list;
+      for( uint32_t i = 0; i < entries; ++i )
+      {
+         list.emplace_back( fc::mutable_variant_object( "id", i )
+                            ( "account", "account-" + fc::to_string( uint64_t(i) ) )
+                            ( "memo", "a memo with \"quotes\" and a\ttab that is long enough to span blocks" )
+                            ( "amount", int64_t(i) * 1000 - 7 )
+                            ( "ratio", i * 0.25 )
+                            ( "flags", fc::variants{ fc::variant( true ), fc::variant( false ), fc::variant() } ) );
+      }
+      return fc::json::to_string( fc::variant( list ) );
+   }
+
+   template<typename F>
+   void report( const char* name, const std::string& doc, uint32_t rounds, F&& f )
+   {
+      f(); // warm up
+      const auto start = std::chrono::steady_clock::now();
+      for( uint32_t i = 0; i < rounds; ++i )
+         f();
+      const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      std::cout << name << ": " << ( double(doc.size()) * rounds / seconds / 1e9 ) << " GB/s\n";
+   }
+
+}
+
+int main( int argc, char** argv )
+{
+   const std::string doc = make_document( 20000 );
+   const uint32_t rounds = 10;
+   std::cout << "document: " << doc.size() << " bytes\n";
+
+   fc::json_structural::structural_index index;
+   report( "structural index", doc, rounds, [&]() {
+      fc::json_structural::build_index( doc.data(), doc.size(), index );
+   });
+   report( "structural_parser", doc, rounds, [&]() {
+      fc::json::from_string( doc, fc::json::structural_parser );
+   });
+   report( "legacy_parser", doc, rounds, [&]() {
+      fc::json::from_string( doc, fc::json::legacy_parser );
+   });
+   report( "is_valid", doc, rounds, [&]() {
+      size_t error_offset;
+      fc::json::is_valid( doc, error_offset );
+   });
+   report( "json_push_parser", doc, rounds, [&]() {
+      fc::json_push_parser parser;
+      for( size_t i = 0; i < doc.size(); i += 4096 )
+         parser.feed( doc.data() + i, std::min<size_t>( 4096, doc.size() - i ) );
+   });
+   report( "json_subtree_reader", doc, rounds, [&]() {
+      fc::json_subtree_reader::read( doc.data(), doc.size(), 1, []( fc::variant&& ) {} );
+   });
+   const fc::json_extractor extractor( { { "0", "account" }, { "19999", "id" } } );
+   report( "json_extractor", doc, rounds, [&]() {
+      extractor.values( doc );
+   });
+
+   const fc::variant value = fc::json::from_string( doc );
+   report( "to_string", doc, rounds, [&]() {
+      fc::json::to_string( value );
+   });
+   std::string reused;
+   report( "to_string into a reused string", doc, rounds, [&]() {
+      reused.clear();
+      fc::json::to_string( value, reused );
+   });
+   report( "to_stream", doc, rounds, [&]() {
+      fc::stringstream ss;
+      fc::json::to_stream( ss, value );
+   });
+   report( "to_pretty_string", doc, rounds, [&]() {
+      fc::json::to_pretty_string( value );
+   });
+   report( "to_string_parallel", doc, rounds, [&]() {
+      fc::json::to_string_parallel( value );
+   });
+
+   const std::string ndjson = fc::json::to_ndjson( value.get_array() );
+   report( "to_ndjson", ndjson, rounds, [&]() {
+      fc::json::to_ndjson( value.get_array() );
+   });
+   report( "variants_from_ndjson, structural_parser", ndjson, rounds, [&]() {
+      fc::json::variants_from_ndjson( ndjson, fc::json::structural_parser );
+   });
+   return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ *  Reports the throughput of writing long strings with json_buffer::write_string, against looking
+ *  for escapes one character at a time, for plain ASCII text, hex and base64 blobs, text with a few
+ *  escapes and text that is mostly escapes.
+ */
+#include <fc/io/json.hpp>
+#include <fc/crypto/base64.hpp>
+#include <fc/crypto/hex.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+   /** write_string as it was, looking at one character at a time for the next escape */
+   void escape_scalar( const std::string& str, std::string& out )
+   {
+      static const char hex[] = "0123456789abcdef";
+      out.reserve( out.size() + str.size() + 2 );
+      out.push_back( '"' );
+      const char* end = str.data() + str.size();
+      const char* run = str.data();
+      for( const char* itr = run; itr != end; ++itr )
+      {
+         const unsigned char c = *itr;
+         if( c >= 0x20 && c != '"' && c != '\\' )
+            continue;
+         out.append( run, itr );
+         run = itr + 1;
+         switch( c )
+         {
+            case '\b': out.append( "\\b", 2 ); break;
+            case '\f': out.append( "\\f", 2 ); break;
+            case '\n': out.append( "\\n", 2 ); break;
+            case '\r': out.append( "\\r", 2 ); break;
+            case '\t': out.append( "\\t", 2 ); break;
+            case '\\': out.append( "\\\\", 2 ); break;
+            case '"':  out.append( "\\\"", 2 ); break;
+            default:
+            {
+               const char escaped[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+               out.append( escaped, sizeof(escaped) );
+            }
+         }
+      }
+      out.append( run, end );
+      out.push_back( '"' );
+   }
+
+   template<typename F>
+   double throughput( const std::string& str, uint32_t rounds, F&& f )
+   {
+      const auto start = std::chrono::steady_clock::now();
+      for( uint32_t i = 0; i < rounds; ++i )
+         f();
+      const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      return double(str.size()) * rounds / seconds / 1e9;
+   }
+
+   void report( const char* name, const std::string& str, uint32_t rounds )
+   {
+      std::string out;
+      const double scalar = throughput( str, rounds, [&]() {
+         out.clear();
+         escape_scalar( str, out );
+      });
+      const std::string expected = out;
+
+      const double vectorized = throughput( str, rounds, [&]() {
+         out.clear();
+         fc::json_buffer buffer( out );
+         buffer.write_string( str.data(), str.size() );
+      });
+      if( out != expected )
+      {
+         std::cout << name << ": write_string differs from the scalar escaping\n";
+         std::exit( 1 );
+      }
+      std::cout << name << ": " << scalar << " GB/s a character at a time, " << vectorized << " GB/s write_string\n";
+   }
+
+}
+
+int main( int argc, char** argv )
+{
+   const uint32_t rounds = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 200;
+   const size_t size = 1024 * 1024;
+
+   std::string ascii;
+   while( ascii.size() < size )
+      ascii += "Payment for invoice 4711, thanks for the quick delivery of the parts. ";
+
+   std::vector<char> bytes( size / 2 );
+   for( size_t i = 0; i < bytes.size(); ++i )
+      bytes[i] = char( i * 7919 >> 3 );
+   const std::string hex = fc::to_hex( bytes.data(), bytes.size() );
+   const std::string base64 = fc::base64_encode( bytes.data(), bytes.size() );
+
+   std::string few_escapes;
+   while( few_escapes.size() < size )
+      few_escapes += "line with a \"quote\" and a tab\there\n";
+
+   std::string escapes;
+   while( escapes.size() < size )
+      escapes += "\"\\\n\t\x01" "a";
+
+   report( "ascii", ascii, rounds );
+   report( "hex", hex, rounds );
+   report( "base64", base64, rounds );
+   report( "few escapes", few_escapes, rounds );
+   report( "mostly escapes", escapes, rounds / 4 + 1 );
+   return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ *  Reports the throughput of json::from_file on a large file, against reading the file into a
+ *  string and parsing that.  The size of the file in MB is the optional argument.
+ */
+#include <fc/variant.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+   void write_document( const fc::path& p, uint64_t bytes )
+   {
+      fc::ofstream o( p );
+      o.write( "[", 1 );
+      for( uint64_t written = 1, i = 0; written < bytes; ++i )
+      {
+         const std::string entry = ( i ? "," : "" ) + fc::json::to_string( fc::mutable_variant_object( "id", i )
+                                      ( "account", "account-" + fc::to_string( i ) )
+                                      ( "memo", "a memo with \"quotes\" and a\ttab" )
+                                      ( "amount", int64_t(i) * 1000 - 7 )
+                                      ( "ratio", i * 0.25 ) );
+         o.write( entry.data(), entry.size() );
+         written += entry.size();
+      }
+      o.write( "]", 1 );
+   }
+
+   template<typename F>
+   void report( const char* name, uint64_t bytes, F&& f )
+   {
+      const auto start = std::chrono::steady_clock::now();
+      f();
+      const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      std::cout << name << ": " << ( double(bytes) / seconds / 1e6 ) << " MB/s\n";
+   }
+
+}
+
+int main( int argc, char** argv )
+{
+   const uint64_t megabytes = argc > 1 ? std::strtoull( argv[1], nullptr, 10 ) : 128;
+   fc::temp_file file;
+   write_document( file.path(), megabytes * 1024 * 1024 );
+   const uint64_t bytes = fc::file_size( file.path() );
+   std::cout << "file: " << bytes << " bytes\n";
+
+   report( "read_file_contents + from_string legacy_parser", bytes, [&]() {
+      std::string text;
+      fc::read_file_contents( file.path(), text );
+      fc::json::from_string( text, fc::json::legacy_parser );
+   });
+   report( "from_file legacy_parser", bytes, [&]() {
+      fc::json::from_file( file.path(), fc::json::legacy_parser );
+   });
+   report( "read_file_contents + from_string structural_parser", bytes, [&]() {
+      std::string text;
+      fc::read_file_contents( file.path(), text );
+      fc::json::from_string( text, fc::json::structural_parser );
+   });
+   report( "from_file structural_parser", bytes, [&]() {
+      fc::json::from_file( file.path(), fc::json::structural_parser );
+   });
+   return 0;
+}
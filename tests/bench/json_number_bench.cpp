@@ -0,0 +1,118 @@
+/**
+ *  Reports the throughput of json::from_string on a number heavy document, shaped like price feeds
+ *  and balances, for the legacy and the structural parser, and of converting its numbers alone
+ *  with the json_number functions against the lexical_cast of to_double() and friends.
+ */
+#include <fc/variant.hpp>
+#include <fc/io/json.hpp>
+#include <fc/io/json_number.hpp>
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+   /** written out here, fc writes doubles as strings */
+   std::string make_document( uint32_t entries )
+   {
+      std::string doc = "[";
+      for( uint32_t i = 0; i < entries; ++i )
+      {
+         doc += "{\"id\":" + std::to_string( i )
+              + ",\"price\":" + std::to_string( 1000 + i * 0.0625 )
+              + ",\"base\":" + std::to_string( int64_t(i) * 7919 - 3000000 )
+              + ",\"quote\":" + std::to_string( uint64_t(i) * 104729 )
+              + ",\"rate\":" + std::to_string( 0.001 * ( i % 997 ) ) + "},";
+      }
+      doc.back() = ']';
+      return doc;
+   }
+
+   /** the numbers of the document, as the parsers cut them out */
+   std::vector<std::string> numbers_of( const std::string& doc )
+   {
+      std::vector<std::string> numbers;
+      for( size_t i = 0; i < doc.size(); )
+      {
+         const size_t start = i;
+         while( i < doc.size() && ( isdigit( doc[i] ) || doc[i] == '-' || doc[i] == '.' ) )
+            ++i;
+         if( i != start )
+            numbers.push_back( doc.substr( start, i - start ) );
+         else
+            ++i;
+      }
+      return numbers;
+   }
+
+   template<typename F>
+   void report( const char* name, size_t bytes, uint32_t rounds, F&& f )
+   {
+      f(); // warm up
+      const auto start = std::chrono::steady_clock::now();
+      for( uint32_t i = 0; i < rounds; ++i )
+         f();
+      const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      std::cout << name << ": " << ( double(bytes) * rounds / seconds / 1e9 ) << " GB/s\n";
+   }
+
+   template<typename Convert>
+   double convert_all( const std::vector<std::string>& numbers, Convert&& convert )
+   {
+      double sum = 0;
+      for( const auto& n : numbers )
+      {
+         if( n.find( '.' ) != std::string::npos )
+            sum += convert( n, double() );
+         else if( n[0] == '-' )
+            sum += convert( n, int64_t() );
+         else
+            sum += convert( n, uint64_t() );
+      }
+      return sum;
+   }
+
+}
+
+int main( int argc, char** argv )
+{
+   const std::string doc = make_document( 20000 );
+   const uint32_t rounds = 10;
+   std::cout << "document: " << doc.size() << " bytes\n";
+
+   report( "legacy_parser", doc.size(), rounds, [&]() {
+      fc::json::from_string( doc, fc::json::legacy_parser );
+   });
+   report( "structural_parser", doc.size(), rounds, [&]() {
+      fc::json::from_string( doc, fc::json::structural_parser );
+   });
+
+   const std::vector<std::string> numbers = numbers_of( doc );
+   size_t bytes = 0;
+   for( const auto& n : numbers )
+      bytes += n.size();
+   std::cout << numbers.size() << " numbers, " << bytes << " bytes\n";
+
+   double lexical = 0;
+   double direct = 0;
+   report( "to_double, to_int64 and to_uint64", bytes, rounds, [&]() {
+      lexical = convert_all( numbers, []( const std::string& n, auto type ) -> double {
+         return std::is_same<decltype(type), double>::value ? fc::to_double( n )
+              : std::is_same<decltype(type), int64_t>::value ? double( fc::to_int64( n ) ) : double( fc::to_uint64( n ) );
+      });
+   });
+   report( "json_number", bytes, rounds, [&]() {
+      direct = convert_all( numbers, []( const std::string& n, auto type ) -> double {
+         const char* end = n.data() + n.size();
+         return std::is_same<decltype(type), double>::value ? fc::json_number::to_double( n.data(), end )
+              : std::is_same<decltype(type), int64_t>::value ? double( fc::json_number::to_int64( n.data(), end ) )
+                                                             : double( fc::json_number::to_uint64( n.data(), end ) );
+      });
+   });
+   if( lexical != direct )
+   {
+      std::cout << "json_number converts differently\n";
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,190 @@
+/**
+ *  Reports the throughput of fc::raw::pack and unpack on vectors of ids, amounts and digests,
+ *  against packing the same elements one at a time as pack did before it copied them in bulk.
+ *  Also times packing records with and without a test run with datastream<size_t>, which
+ *  pack() skips for types with a static_pack_size, and appending them all to one buffer
+ *  through a growable_datastream, and unpacking them with their strings copied against
+ *  viewed in place, or only their expiration with unpack_members.
+ */
+#include <fc/io/raw.hpp>
+#include <fc/io/raw_view.hpp>
+#include <fc/io/raw_skip.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/crypto/ripemd160.hpp>
+
+#include <chrono>
+#include <iostream>
+
+namespace fc_raw_bench {
+   struct transfer
+   {
+      std::string             from;
+      std::string             to;
+      int64_t                 amount = 0;
+      std::string             memo;
+      fc::time_point_sec      expiration;
+   };
+
+   /** transfer, read without copying its strings */
+   struct transfer_view
+   {
+      fc::raw::string_view    from;
+      fc::raw::string_view    to;
+      int64_t                 amount = 0;
+      fc::raw::string_view    memo;
+      fc::time_point_sec      expiration;
+   };
+
+   struct block_header
+   {
+      fc::ripemd160           previous;
+      fc::time_point_sec      timestamp;
+      uint32_t                witness = 0;
+      fc::sha256              merkle_root;
+   };
+}
+
+FC_REFLECT( fc_raw_bench::transfer, (from)(to)(amount)(memo)(expiration) )
+FC_REFLECT( fc_raw_bench::transfer_view, (from)(to)(amount)(memo)(expiration) )
+FC_REFLECT( fc_raw_bench::block_header, (previous)(timestamp)(witness)(merkle_root) )
+
+namespace {
+
+   template<typename F>
+   void report( const char* name, size_t bytes, uint32_t rounds, F&& f )
+   {
+      f(); // warm up
+      const auto start = std::chrono::steady_clock::now();
+      for( uint32_t i = 0; i < rounds; ++i )
+         f();
+      const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      std::cout << name << ": " << ( double(bytes) * rounds / seconds / 1e9 ) << " GB/s\n";
+   }
+
+   template<typename T>
+   void compare( const char* name, const std::vector<T>& value, uint32_t rounds )
+   {
+      const std::vector<char> packed = fc::raw::pack( value );
+      std::cout << name << ", " << value.size() << " elements, " << packed.size() << " bytes\n";
+
+      std::vector<char> buffer( packed.size() );
+      report( "  pack one by one", packed.size(), rounds, [&]() {
+         fc::datastream<char*> ds( buffer.data(), buffer.size() );
+         fc::raw::pack( ds, fc::unsigned_int( (uint32_t)value.size() ) );
+         for( const auto& e : value )
+            fc::raw::pack( ds, e );
+      });
+      report( "  pack", packed.size(), rounds, [&]() {
+         fc::datastream<char*> ds( buffer.data(), buffer.size() );
+         fc::raw::pack( ds, value );
+      });
+
+      std::vector<T> unpacked;
+      report( "  unpack one by one", packed.size(), rounds, [&]() {
+         fc::datastream<const char*> ds( packed.data(), packed.size() );
+         fc::unsigned_int size;
+         fc::raw::unpack( ds, size );
+         unpacked.resize( size.value );
+         for( auto& e : unpacked )
+            fc::raw::unpack( ds, e );
+      });
+      report( "  unpack", packed.size(), rounds, [&]() {
+         fc::datastream<const char*> ds( packed.data(), packed.size() );
+         fc::raw::unpack( ds, unpacked );
+      });
+   }
+
+   template<typename T>
+   void compare_passes( const char* name, const std::vector<T>& records, uint32_t rounds )
+   {
+      size_t bytes = 0;
+      for( const auto& r : records )
+         bytes += fc::raw::pack_size( r );
+      std::cout << name << ", " << records.size() << " records, " << bytes << " bytes\n";
+
+      report( "  pack in two passes", bytes, rounds, [&]() {
+         for( const auto& r : records )
+         {
+            fc::datastream<size_t> ps;
+            fc::raw::pack( ps, r );
+            std::vector<char> packed( ps.tellp() );
+            fc::datastream<char*> ds( packed.data(), packed.size() );
+            fc::raw::pack( ds, r );
+         }
+      });
+      report( "  pack", bytes, rounds, [&]() {
+         for( const auto& r : records )
+            fc::raw::pack( r );
+      });
+
+      std::vector<char> log;
+      report( "  append pack() to one buffer", bytes, rounds, [&]() {
+         log.clear();
+         for( const auto& r : records )
+         {
+            const std::vector<char> packed = fc::raw::pack( r );
+            log.insert( log.end(), packed.begin(), packed.end() );
+         }
+      });
+      report( "  growable_datastream", bytes, rounds, [&]() {
+         log.clear();
+         fc::growable_datastream< std::vector<char> > ds( log );
+         for( const auto& r : records )
+            fc::raw::pack( ds, r );
+      });
+   }
+
+}
+
+int main( int argc, char** argv )
+{
+   const uint32_t count = 200000;
+   const uint32_t rounds = 50;
+
+   std::vector<uint64_t> ids;
+   std::vector<int64_t> amounts;
+   std::vector<fc::sha256> hashes;
+   std::vector<fc::ripemd160> ripemds;
+   for( uint32_t i = 0; i < count; ++i )
+   {
+      ids.push_back( uint64_t(i) * 0x9e3779b97f4a7c15ull );
+      amounts.push_back( int64_t(i) * 7919 - 3000000 );
+      hashes.push_back( fc::sha256::hash( (const char*)&i, sizeof(i) ) );
+      ripemds.push_back( fc::ripemd160::hash( (const char*)&i, sizeof(i) ) );
+   }
+
+   compare( "uint64_t ids", ids, rounds );
+   compare( "int64_t amounts", amounts, rounds );
+   compare( "sha256 digests", hashes, rounds );
+   compare( "ripemd160 digests", ripemds, rounds );
+
+   std::vector<fc_raw_bench::transfer> transfers;
+   std::vector<fc_raw_bench::block_header> headers;
+   for( uint32_t i = 0; i < count / 10; ++i )
+   {
+      const std::string n = fc::to_string( uint64_t(i) );
+      transfers.push_back( fc_raw_bench::transfer{ "alice" + n, "bob" + n, int64_t(i) * 1000,
+                                                   "memo number " + n, fc::time_point_sec( 1500000000 + i ) } );
+      headers.push_back( fc_raw_bench::block_header{ ripemds[i], fc::time_point_sec( 1500000000 + i * 3 ), i % 21, hashes[i] } );
+   }
+   compare_passes( "transfers", transfers, rounds / 5 );
+   compare_passes( "block headers", headers, rounds / 5 );
+
+   const std::vector<char> packed_transfers = fc::raw::pack( transfers );
+   std::cout << "unpacking the transfers\n";
+   report( "  strings", packed_transfers.size(), rounds / 5, [&]() {
+      fc::raw::unpack< std::vector<fc_raw_bench::transfer> >( packed_transfers );
+   });
+   report( "  string_views", packed_transfers.size(), rounds / 5, [&]() {
+      fc::raw::unpack< std::vector<fc_raw_bench::transfer_view> >( packed_transfers );
+   });
+   report( "  expirations only", packed_transfers.size(), rounds / 5, [&]() {
+      fc::datastream<const char*> ds( packed_transfers.data(), packed_transfers.size() );
+      fc::unsigned_int count;
+      fc::raw::unpack( ds, count );
+      fc_raw_bench::transfer t;
+      for( uint32_t i = 0; i < count.value; ++i )
+         fc::raw::unpack_members( ds, t, &fc_raw_bench::transfer::expiration );
+   });
+   return 0;
+}
@@ -0,0 +1,72 @@
+/**
+ *  Times parsing a request sized JSON document and converting a reflected object to a
+ *  variant, each freed right away, with every node on the heap against the nodes in a
+ *  variant_arena.
+ */
+#include <fc/variant.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/variant_arena.hpp>
+#include <fc/io/json.hpp>
+#include <fc/reflect/variant.hpp>
+
+#include <chrono>
+#include <iostream>
+
+namespace fc_arena_bench {
+   struct account
+   {
+      uint64_t                   id = 0;
+      std::string                name;
+      std::vector<std::string>   tags;
+      std::map<std::string, std::string> meta;
+   };
+}
+FC_REFLECT( fc_arena_bench::account, (id)(name)(tags)(meta) )
+
+namespace {
+
+   template<typename F>
+   void run( const char* name, uint32_t rounds, F&& f )
+   {
+      auto start = std::chrono::steady_clock::now();
+      uint64_t result = 0;
+      for( uint32_t i = 0; i < rounds; ++i )
+         result += f();
+      auto us = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count();
+      std::cout << name << ": " << us / rounds << " us per round (" << result / rounds << ")\n";
+   }
+}
+
+int main( int argc, char** argv )
+{
+   std::vector<fc_arena_bench::account> accounts;
+   for( uint32_t i = 0; i < 2000; ++i )
+   {
+      const std::string n = fc::to_string( uint64_t(i) );
+      accounts.push_back( fc_arena_bench::account{ i, "account-name-long-" + n, { "a", "bb", "a-long-tag-value-" + n },
+                                                   { { "x", "1" }, { "y", "a longer value of " + n } } } );
+   }
+   const std::string doc = fc::json::to_string( fc::variant( accounts ) );
+   const uint32_t rounds = 20;
+
+   run( "parse, heap        ", rounds, [&]() { return fc::json::from_string( doc ).size(); } );
+   run( "parse, arena       ", rounds, [&]()
+   {
+      fc::variant_arena arena;
+      return fc::json::from_string( doc, arena ).size();
+   });
+   run( "to_variant, heap   ", rounds, [&]()
+   {
+      fc::variant v;
+      fc::to_variant( accounts, v );
+      return v.size();
+   });
+   run( "to_variant, arena  ", rounds, [&]()
+   {
+      fc::variant_arena arena;
+      fc::variant v;
+      fc::to_variant( accounts, v, arena );
+      return v.size();
+   });
+   return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ *  Compares walking deep variant trees through the virtual variant::visitor with the
+ *  template variant::visit( F&& ), and times the raw and JSON serializers built on it.
+ */
+#include <fc/variant.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/io/raw_variant.hpp>
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+   fc::variant make_tree( uint32_t depth, uint32_t width )
+   {
+      if( depth == 0 )
+      {
+         fc::variants leaves;
+         for( uint32_t i = 0; i < width; ++i )
+            leaves.emplace_back( i % 2 ? fc::variant( int64_t(i) ) : fc::variant( "leaf" ) );
+         return fc::variant( std::move( leaves ) );
+      }
+      fc::mutable_variant_object obj;
+      for( uint32_t i = 0; i < width; ++i )
+         obj( "child" + fc::to_string( uint64_t(i) ), make_tree( depth - 1, width ) );
+      obj( "value", 0.5 )( "flag", true );
+      return fc::variant( std::move( obj ) );
+   }
+
+   class virtual_counter : public fc::variant::visitor
+   {
+      public:
+         virtual_counter( uint64_t& n ):count(n){}
+         virtual void handle()const                              { ++count; }
+         virtual void handle( const int64_t& v )const            { count += 1 + (v & 1); }
+         virtual void handle( const uint64_t& v )const           { count += 1 + (v & 1); }
+         virtual void handle( const double& v )const             { ++count; }
+         virtual void handle( const bool& v )const               { count += 1 + v; }
+         virtual void handle( const fc::string& v )const         { count += 1 + v.size(); }
+         virtual void handle( const fc::variant_object& o )const
+         {
+            ++count;
+            for( const auto& e : o )
+               e.value().visit( *this );
+         }
+         virtual void handle( const fc::variants& a )const
+         {
+            ++count;
+            for( const auto& v : a )
+               v.visit( *this );
+         }
+         uint64_t& count;
+   };
+
+   struct template_counter
+   {
+      void operator()()const                              { ++count; }
+      void operator()( int64_t v )const                   { count += 1 + (v & 1); }
+      void operator()( uint64_t v )const                  { count += 1 + (v & 1); }
+      void operator()( double v )const                    { ++count; }
+      void operator()( bool v )const                      { count += 1 + v; }
+      void operator()( const fc::string& v )const         { count += 1 + v.size(); }
+      void operator()( const fc::blob& v )const           { ++count; }
+      void operator()( const fc::variant_object& o )const
+      {
+         ++count;
+         for( const auto& e : o )
+            e.value().visit( *this );
+      }
+      void operator()( const fc::variants& a )const
+      {
+         ++count;
+         for( const auto& v : a )
+            v.visit( *this );
+      }
+      uint64_t& count;
+   };
+
+   template<typename F>
+   void run( const char* name, uint32_t rounds, F&& f )
+   {
+      auto start = std::chrono::steady_clock::now();
+      uint64_t result = 0;
+      for( uint32_t i = 0; i < rounds; ++i )
+         result += f();
+      auto us = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count();
+      std::cout << name << ": " << us / rounds << " us per round (" << result / rounds << ")\n";
+   }
+}
+
+int main( int argc, char** argv )
+{
+   const fc::variant tree = make_tree( 6, 5 );
+   const uint32_t rounds = 20;
+
+   run( "virtual visitor", rounds, [&]() { uint64_t n = 0; tree.visit( virtual_counter( n ) ); return n; } );
+   run( "template visit ", rounds, [&]() { uint64_t n = 0; tree.visit( template_counter{ n } ); return n; } );
+   run( "walk_variant   ", rounds, [&]()
+   {
+      uint64_t n = 0;
+      fc::walk_variant( tree, [&]( const fc::variant& v, uint32_t ) { ++n; } );
+      return n;
+   });
+   run( "raw::pack      ", rounds, [&]() { return uint64_t( fc::raw::pack( tree ).size() ); } );
+   run( "json::to_string", rounds, [&]() { return uint64_t( fc::json::to_string( tree ).size() ); } );
+   return 0;
+}
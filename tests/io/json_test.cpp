@@ -0,0 +1,873 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/io/json_extractor.hpp>
+#include <fc/io/json_number.hpp>
+#include <fc/io/json_push_parser.hpp>
+#include <fc/io/json_sax.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/static_variant.hpp>
+#include <fc/container/flat.hpp>
+#include <fc/time.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/io/sstream.hpp>
+#include <cstdlib>
+#include <new>
+
+namespace fc_json_test {
+   /** counts the allocations of the calling thread, for the checks that are meant not to allocate */
+   thread_local size_t allocations = 0;
+}
+
+void* operator new( size_t size )
+{
+   ++fc_json_test::allocations;
+   if( void* p = malloc( size ? size : 1 ) )
+      return p;
+   throw std::bad_alloc();
+}
+void operator delete( void* p ) noexcept { free( p ); }
+void operator delete( void* p, size_t ) noexcept { free( p ); }
+
+namespace fc_json_test {
+   enum class color { red, green };
+
+   struct price
+   {
+      int64_t amount = 0;
+   };
+
+   struct item
+   {
+      std::string              name;
+      color                    tint = color::red;
+      fc::optional<uint32_t>   weight;
+      price                    cost;
+   };
+
+   struct order
+   {
+      uint64_t                              id = 0;
+      int32_t                               delta = 0;
+      double                                ratio = 0;
+      bool                                  open = false;
+      std::vector<item>                     items;
+      std::map<std::string, int64_t>        totals;
+      fc::flat_set<uint16_t>                tags;
+      fc::static_variant<price, std::string> extra;
+      std::pair<int8_t, std::string>        note;
+      fc::variant                           meta;
+      fc::time_point_sec                    created;
+      std::shared_ptr<item>                 parent;
+      std::vector<fc::optional<color>>      history;
+   };
+
+   struct transfer
+   {
+      std::string from;
+      std::string to;
+      int64_t     amount = 0;
+   };
+
+   struct vote
+   {
+      std::string voter;
+      int16_t     weight = 0;
+   };
+
+   typedef fc::static_variant<transfer, vote> operation;
+
+   /** the containers and static_variants of it have conversions of their own as well */
+   struct transaction
+   {
+      uint32_t                      ref_block = 0;
+      std::vector<operation>        operations;
+      fc::optional<operation>       extension;
+      std::pair<operation, bool>    first;
+      std::vector<vote>             votes;
+   };
+}
+
+FC_REFLECT_ENUM( fc_json_test::color, (red)(green) )
+FC_REFLECT( fc_json_test::price, (amount) )
+FC_REFLECT( fc_json_test::item, (name)(tint)(weight)(cost) )
+FC_REFLECT( fc_json_test::order, (id)(delta)(ratio)(open)(items)(totals)(tags)(extra)(note)(meta)(created)(parent)(history) )
+FC_REFLECT( fc_json_test::transfer, (from)(to)(amount) )
+FC_REFLECT( fc_json_test::vote, (voter)(weight) )
+FC_REFLECT( fc_json_test::transaction, (ref_block)(operations)(extension)(first)(votes) )
+
+namespace fc {
+   // reflected types may still define their own conversion, which the writer must honour
+   void to_variant( const fc_json_test::price& p, fc::variant& v ) { v = fc::to_string( p.amount ) + " SCR"; }
+   void from_variant( const fc::variant& v, fc_json_test::price& p )
+   {
+      const std::string s = v.as_string();
+      p.amount = fc::to_int64( s.substr( 0, s.find( ' ' ) ) );
+   }
+
+   // operations are written as ["name",{...}] rather than [which,{...}], the way chains name them
+   static const char* const operation_names[] = { "transfer", "vote" };
+
+   void to_variant( const fc_json_test::operation& op, fc::variant& v )
+   {
+      fc::variants pair( 2 );
+      pair[0] = operation_names[op.which()];
+      op.visit( fc::from_static_variant( pair[1] ) );
+      v = std::move( pair );
+   }
+   void from_variant( const fc::variant& v, fc_json_test::operation& op )
+   {
+      const fc::variants& pair = v.get_array();
+      const std::string name = pair[0].as_string();
+      op.set_which( name == operation_names[0] ? 0 : 1 );
+      op.visit( fc::to_static_variant( pair[1] ) );
+   }
+
+   // a container with a conversion of its own is not walked either
+   void to_variant( const std::vector<fc_json_test::vote>& votes, fc::variant& v ) { v = votes.size(); }
+   void from_variant( const fc::variant& v, std::vector<fc_json_test::vote>& votes ) { votes.resize( v.as_uint64() ); }
+}
+
+BOOST_AUTO_TEST_SUITE(fc_json)
+
+BOOST_AUTO_TEST_CASE(reflected_writer_matches_variant)
+{
+   fc_json_test::order o;
+   o.id = 0x100000000ull;
+   o.delta = -7;
+   o.ratio = 0.25;
+   o.open = true;
+   o.items.resize( 2 );
+   o.items[0].name = "first \"quoted\"\n";
+   o.items[0].weight = 12;
+   o.items[0].cost.amount = 5;
+   o.items[1].name = "second";
+   o.items[1].tint = fc_json_test::color::green;
+   o.totals["a"] = -1;
+   o.totals["b"] = 0x1ffffffffll;
+   o.tags = { 3, 1, 2 };
+   o.extra = std::string( "text" );
+   o.note = std::make_pair( int8_t(-3), std::string( "pair" ) );
+   o.meta = fc::mutable_variant_object( "k", fc::variants{ fc::variant( 1 ), fc::variant() } );
+   o.created = fc::time_point_sec( 1500000000 );
+   o.history = { fc::optional<fc_json_test::color>(), fc_json_test::color::green };
+
+   for( auto format : { fc::json::stringify_large_ints_and_doubles, fc::json::legacy_generator } )
+   {
+      BOOST_CHECK_EQUAL( fc::json::to_string( o, format ), fc::json::to_string( fc::variant( o ), format ) );
+
+      o.parent = std::make_shared<fc_json_test::item>( o.items[1] );
+      o.extra = fc_json_test::price{ 9 };
+      BOOST_CHECK_EQUAL( fc::json::to_string( o, format ), fc::json::to_string( fc::variant( o ), format ) );
+      BOOST_CHECK_EQUAL( fc::json::to_pretty_string( o, format ), fc::json::to_pretty_string( fc::variant( o ), format ) );
+      o.parent.reset();
+      o.extra = std::string( "text" );
+   }
+
+   BOOST_CHECK_EQUAL( fc::json::to_string( o.items[0].cost ), "\"5 SCR\"" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc_json_test::color::green ), "\"green\"" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( std::string( "a\tb" ) ), "\"a\\tb\"" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( std::vector<char>{ 'a' } ), "\"61\"" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc_json_test::order() ), fc::json::to_string( fc::variant( fc_json_test::order() ) ) );
+}
+
+BOOST_AUTO_TEST_CASE(buffer_writer_formats_like_streams)
+{
+   const double doubles[] = { 0.0, -0.0, 0.1, 1.0 / 3, 1e300, -1e-300, 123456789.123456789,
+                              std::numeric_limits<double>::infinity(), std::numeric_limits<double>::max(),
+                              std::numeric_limits<double>::denorm_min() };
+   for( double d : doubles )
+   {
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( d ), fc::json::legacy_generator ), fc::to_string( d ) );
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( d ) ), "\"" + fc::to_string( d ) + "\"" );
+   }
+
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( std::numeric_limits<int64_t>::min() ) ), "-9223372036854775808" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( std::numeric_limits<int64_t>::max() ) ), "\"9223372036854775807\"" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( std::numeric_limits<uint64_t>::max() ), fc::json::legacy_generator ),
+                      "18446744073709551615" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( uint64_t(0xffffffff) ) ), "4294967295" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( int64_t(0x100000000) ) ), "\"4294967296\"" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( int64_t(-0x100000001) ) ), "-4294967297" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( 0 ) ), "0" );
+
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( std::string( "\x01\a\b\t\n\x0b\f\r\x1f \"\\/\x7f\xc3\xa9", 16 ) ) ),
+                      "\"\\u0001\\u0007\\b\\t\\n\\u000b\\f\\r\\u001f \\\"\\\\/\x7f\xc3\xa9\"" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( std::string( "a\0b", 3 ) ) ), "\"a\\u0000b\"" );
+
+   // every byte at every position of the 16 and 32 byte blocks that are scanned together
+   for( int c = 0; c < 256; ++c )
+      for( size_t pos : { size_t(0), size_t(15), size_t(16), size_t(31), size_t(32), size_t(47), size_t(70) } )
+      {
+         std::string str( 72, 'x' );
+         str[pos] = char(c);
+         const std::string escaped = fc::json::to_string( fc::variant( str ) );
+         const std::string single = fc::json::to_string( fc::variant( std::string( 1, char(c) ) ) );
+         BOOST_CHECK_EQUAL( escaped, "\"" + std::string( pos, 'x' ) + single.substr( 1, single.size() - 2 ) +
+                                     std::string( 71 - pos, 'x' ) + "\"" );
+         BOOST_CHECK_EQUAL( single.size() > 3, c < 0x20 || c == '"' || c == '\\' );
+      }
+
+   // a reused string keeps its capacity and only gets the new document appended
+   const fc::variant doc = fc::mutable_variant_object( "id", 1 )( "list", fc::variants{ fc::variant( 2.5 ), fc::variant( "x" ) } );
+   std::string out = "prefix";
+   fc::json::to_string( doc, out );
+   BOOST_CHECK_EQUAL( out, "prefix" + fc::json::to_string( doc ) );
+   out.clear();
+   const size_t capacity = out.capacity();
+   fc::json::to_string( doc, out );
+   BOOST_CHECK_EQUAL( out, fc::json::to_string( doc ) );
+   BOOST_CHECK_EQUAL( out.capacity(), capacity );
+
+   // ostream targets get the same text, also when it is handed over in several pieces
+   fc::variants big;
+   for( int i = 0; i < 20000; ++i )
+      big.push_back( fc::mutable_variant_object( "i", i )( "s", std::string( size_t(i % 13), 'z' ) ) );
+   fc::stringstream ss;
+   fc::json::to_stream( ss, fc::variant( big ), fc::json::legacy_generator );
+   BOOST_CHECK( ss.str() == fc::json::to_string( fc::variant( big ), fc::json::legacy_generator ) );
+}
+
+BOOST_AUTO_TEST_CASE(pretty_writer_layout)
+{
+   const auto pretty = []( const std::string& json ) { return fc::json::to_pretty_string( fc::json::from_string( json ) ); };
+   BOOST_CHECK_EQUAL( pretty( "{}" ), "{}" );
+   BOOST_CHECK_EQUAL( pretty( "[[]]" ), "[[]\n]" );
+   BOOST_CHECK_EQUAL( pretty( "[1,[]]" ), "[\n  1,[]\n]" );
+   BOOST_CHECK_EQUAL( pretty( "{\"a\":{\"b\":1},\"c\":[true,null]}" ),
+                      "{\n  \"a\": {\n    \"b\": 1\n  },\n  \"c\": [\n    true,\n    null\n  ]\n}" );
+   BOOST_CHECK_EQUAL( pretty( "[{\"a\":\"x\"},{\"b\":2.5}]" ),
+                      "[{\n    \"a\": \"x\"\n  },{\n    \"b\": \"2.50000000000000000\"\n  }\n]" );
+   BOOST_CHECK_EQUAL( pretty( "{\"k{[,:]}\":\"v{[,:]}\\\"\\\\\"}" ), "{\n  \"k{[,:]}\": \"v{[,:]}\\\"\\\\\"\n}" );
+
+   // escapes other than \n used to put the following text out of step, with line breaks inside strings
+   const fc::variant tabs = fc::mutable_variant_object( "a", "tab\there" )( "b", "x,y" );
+   BOOST_CHECK_EQUAL( fc::json::to_pretty_string( tabs ), "{\n  \"a\": \"tab\\there\",\n  \"b\": \"x,y\"\n}" );
+   BOOST_CHECK_EQUAL( fc::json::to_pretty_string( fc::variants{ fc::variant( std::string( "\x01", 1 ) ), fc::variant( "x,y" ) } ),
+                      "[\n  \"\\u0001\",\n  \"x,y\"\n]" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::json::from_string( fc::json::to_pretty_string( tabs ) ) ), fc::json::to_string( tabs ) );
+
+   fc::mutable_variant_object big;
+   for( int i = 0; i < 5000; ++i )
+      big( "key" + fc::to_string( int64_t(i) ), fc::variants{ fc::variant( i ), fc::variant( i * 0.5 ),
+                                                              fc::mutable_variant_object( "n", i )( "e", fc::variants() ) } );
+   fc::temp_file file;
+   fc::json::save_to_file( fc::variant( big ), file.path(), true );
+   std::string saved;
+   fc::read_file_contents( file.path(), saved );
+   BOOST_CHECK( saved == fc::json::to_pretty_string( fc::variant( big ) ) );
+   fc::json::save_to_file( fc::variant( big ), file.path(), false );
+   fc::read_file_contents( file.path(), saved );
+   BOOST_CHECK( saved == fc::json::to_string( fc::variant( big ) ) );
+}
+
+BOOST_AUTO_TEST_CASE(reflected_reader_matches_variant)
+{
+   fc_json_test::order o;
+   o.id = 0x100000000ull;
+   o.ratio = 1.5;
+   o.items.resize( 1 );
+   o.items[0].name = "with \"escapes\"\t";
+   o.items[0].weight = 3;
+   o.totals["x"] = 4;
+   o.tags = { 7 };
+   o.extra = fc_json_test::price{ 11 };
+   o.note = std::make_pair( int8_t(1), std::string( "n" ) );
+   o.meta = fc::variants{ fc::variant( "m" ) };
+   o.parent = std::make_shared<fc_json_test::item>( o.items[0] );
+   o.history = { fc::optional<fc_json_test::color>(), fc_json_test::color::green };
+
+   auto check = []( const std::string& json )
+   {
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::json::from_string<fc_json_test::order>( json ) ),
+                         fc::json::to_string( fc::json::from_string( json ).as<fc_json_test::order>() ) );
+   };
+   for( auto format : { fc::json::stringify_large_ints_and_doubles, fc::json::legacy_generator } )
+   {
+      const std::string json = fc::json::to_string( o, format );
+      check( json );
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::json::from_string<fc_json_test::order>( json ), format ), json );
+   }
+
+   // lenient legacy grammar, unknown keys, duplicate keys and values that need a conversion
+   check( " { \"id\" : \"12\" ,, \"unknown\":{\"a\":[1,2]}, \"items\":[ ,{\"name\":5,\"tint\":1} ,],"
+          "\"delta\":1,\"delta\":2.5,\"open\":\"true\",\"note\":[3],\"extra\":[1],\"history\":[\"red\",null] } " );
+   check( "{\"totals\":{\"b\":1,\"a\":2,\"b\":3},\"tags\":[3,1,3],\"extra\":[0,\"2 SCR\",\"ignored\"]}" );
+   check( "{}" );
+
+   BOOST_CHECK_EQUAL( fc::json::from_string<std::vector<int32_t>>( "[1, 2,3]" ).size(), 3u );
+   BOOST_CHECK( fc::json::from_string<fc_json_test::color>( "\"green\"" ) == fc_json_test::color::green );
+   BOOST_CHECK_EQUAL( fc::json::from_string<std::string>( "\"a\\\\b\"" ), "a\\b" );
+
+   // malformed and ill typed documents fail the same way as the variant path
+   BOOST_CHECK_THROW( fc::json::from_string<fc_json_test::order>( "{\"id\" 1}" ), fc::parse_error_exception );
+   BOOST_CHECK_THROW( fc::json::from_string<fc_json_test::order>( "{\"id\":1" ), fc::parse_error_exception );
+   BOOST_CHECK_THROW( fc::json::from_string<fc_json_test::order>( "[1]" ), fc::bad_cast_exception );
+   BOOST_CHECK_THROW( fc::json::from_string<fc_json_test::order>( "{\"items\":{}}" ), fc::bad_cast_exception );
+   BOOST_CHECK_THROW( fc::json::from_string<fc_json_test::order>( "{\"extra\":[5,1]}" ), fc::assert_exception );
+   BOOST_CHECK_THROW( fc::json::from_string( "{\"extra\":[5,1]}" ).as<fc_json_test::order>(), fc::assert_exception );
+}
+
+namespace {
+   /** the JSON text of a variant together with the type of every node */
+   std::string typed_dump( const fc::variant& v )
+   {
+      std::string types;
+      fc::walk_variant( v, [&]( const fc::variant& node, uint32_t depth )
+      {
+         types += fc::to_string( uint64_t(depth) ) + ":" + fc::to_string( uint64_t(node.get_type()) ) + " ";
+      });
+      return types + fc::json::to_string( v );
+   }
+
+   /** the legacy and the structural parser must agree on the value or on the exception */
+   void check_structural( const std::string& json )
+   {
+      std::string expected, actual;
+      try { expected = typed_dump( fc::json::from_string( json, fc::json::legacy_parser ) ); }
+      catch( const fc::exception& e ) { expected = std::string( "exception " ) + e.name(); }
+      try { actual = typed_dump( fc::json::from_string( json, fc::json::structural_parser ) ); }
+      catch( const fc::exception& e ) { actual = std::string( "exception " ) + e.name(); }
+      BOOST_CHECK_MESSAGE( expected == actual, "for " + json + ": " + expected + " != " + actual );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(own_conversions_of_static_variants_and_containers)
+{
+   fc_json_test::transaction trx;
+   trx.ref_block = 42;
+   trx.operations.push_back( fc_json_test::transfer{ "alice", "bob", 10 } );
+   trx.operations.push_back( fc_json_test::vote{ "carol", -100 } );
+   trx.extension = fc_json_test::operation( fc_json_test::vote{ "dave", 5 } );
+   trx.first = std::make_pair( trx.operations[0], true );
+   trx.votes.resize( 3 );
+
+   const std::string expected = fc::json::to_string( fc::variant( trx ) );
+   BOOST_CHECK_EQUAL( fc::json::to_string( trx ), expected );
+   BOOST_CHECK_EQUAL( fc::json::to_pretty_string( trx ), fc::json::to_pretty_string( fc::variant( trx ) ) );
+   BOOST_CHECK( expected.find( "[\"transfer\",{\"from\":\"alice\"" ) != std::string::npos );
+   BOOST_CHECK( expected.find( "\"votes\":3" ) != std::string::npos );
+   BOOST_CHECK_EQUAL( fc::json::to_string( trx.operations[1] ), "[\"vote\",{\"voter\":\"carol\",\"weight\":-100}]" );
+
+   const auto read = fc::json::from_string<fc_json_test::transaction>( expected );
+   BOOST_CHECK_EQUAL( fc::json::to_string( read ), expected );
+   BOOST_CHECK_EQUAL( read.operations[1].get<fc_json_test::vote>().voter, "carol" );
+   BOOST_CHECK_EQUAL( read.first.first.get<fc_json_test::transfer>().amount, 10 );
+   BOOST_CHECK_EQUAL( read.votes.size(), 3u );
+   BOOST_CHECK_EQUAL( fc::json::from_string<fc_json_test::operation>( "[\"vote\",{\"voter\":\"erin\"}]" ).get<fc_json_test::vote>().voter, "erin" );
+}
+
+BOOST_AUTO_TEST_CASE(structural_parser_matches_legacy)
+{
+   const std::vector<std::string> corpus = {
+      "{}", "[]", "null", "true", "false", "0", "-1", "18446744073709551615", "18446744073709551616",
+      "-9223372036854775808", "1.5", "-0.25", ".5", "5.", "-.", ".", "-", "1.2.3", "1e5", "12abc", "0x10",
+      "\"\"", "\"plain\"", "\"tab\\tnew\\nline\\rret\\\\slash\\\"quote\\/\\u00e9\"", "\"unterminated",
+      "\"ends with backslash\\", "  \t\n\r {\"a\" : 1 , \"b\":[ 1 ,2 ,, 3, ], \"c\":{}}  trailing",
+      "{\"a\":1,\"a\":2}", "{,\"a\":1,}", "[1 2 3]", "[1-2]", "{\"a\" 1}", "{a:1}", "[nul]", "[truex]",
+      "[trues]", "tru", "nullnull", "[\"a\",]", "{\"k\":[{\"k\":[{\"k\":\"v\"}]}]}", "[1,{]", "[\"a\\", "[",
+      "{", "", "   ", std::string( "{\"a\":\"b\0\"}", 10 ), "[\"\x04\"]", "\"\xc3\xa9t\xc3\xa9\"", "[\xff]", "+1",
+      "{\"id\":1,\"method\":\"call\",\"params\":[\"database_api\",\"get_dynamic_global_properties\",[]]}"
+   };
+   for( const auto& json : corpus )
+      check_structural( json );
+
+   // escapes and quotes on both sides of the 64 byte blocks of the index
+   for( size_t offset = 0; offset < 140; ++offset )
+   {
+      const std::string pad( offset, 'x' );
+      check_structural( "{\"" + pad + "\":\"" + pad + "\\\"q\\\\\"}" );
+      check_structural( "[\"" + pad + "\\\\\\\\\",\"" + pad + "\\\\\\\"\",1]" );
+      check_structural( "[\"" + pad + "\\" );
+   }
+
+   // larger documents with every kind of value
+   fc::mutable_variant_object big;
+   for( int i = 0; i < 200; ++i )
+   {
+      big( "key" + fc::to_string( int64_t(i) ),
+           fc::variants{ fc::variant( i ), fc::variant( -i ), fc::variant( i * 0.5 ), fc::variant( i % 2 == 0 ),
+                         fc::variant(), fc::variant( std::string( size_t(i % 70), 'a' + i % 26 ) + "\"\\\n" ),
+                         fc::mutable_variant_object( "n", i ) } );
+   }
+   check_structural( fc::json::to_string( big ) );
+   check_structural( fc::json::to_string( big, fc::json::legacy_generator ) );
+   check_structural( fc::json::to_pretty_string( big ) );
+
+   // limits are charged the same, also when the structural parser hands over to the legacy one
+   const std::string json = fc::json::to_string( big );
+   fc::parse_limits limits;
+   limits.max_bytes = fc::estimated_size( fc::json::from_string( json ) );
+   BOOST_CHECK_NO_THROW( fc::json::from_string( json, limits, fc::json::structural_parser ) );
+   --limits.max_bytes;
+   BOOST_CHECK_THROW( fc::json::from_string( json, limits, fc::json::structural_parser ), fc::assert_exception );
+   limits = fc::parse_limits();
+   limits.max_nodes = 5;
+   BOOST_CHECK_EQUAL( fc::json::from_string( "[1,2,3,1e5]", limits, fc::json::structural_parser ).size(), 4u );
+}
+
+namespace {
+   /** the first value the push parser completes from @a json fed in pieces of @a chunk bytes */
+   std::string push_first( const std::string& json, size_t chunk )
+   {
+      fc::json_push_parser parser;
+      fc::variants values;
+      try
+      {
+         for( size_t i = 0; i < json.size() && values.empty(); i += chunk )
+            values = parser.feed( json.data() + i, std::min( chunk, json.size() - i ) );
+         if( values.empty() )
+            values = parser.finish();
+      }
+      catch( const fc::exception& e )
+      {
+         if( values.empty() )
+            return std::string( "exception " ) + e.name();
+      }
+      return values.empty() ? std::string( "exception eof_exception" ) : typed_dump( values.front() );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(push_parser_matches_legacy)
+{
+   const std::vector<std::string> corpus = {
+      "{}", "[]", "null", "true", "false", "0", "-1", "18446744073709551615", "18446744073709551616",
+      "-9223372036854775808", "1.5", "-0.25", ".5", "5.", "-.", ".", "-", "1.2.3", "1e5", "12abc", "0x10",
+      "\"\"", "\"plain\"", "\"tab\\tnew\\nline\\rret\\\\slash\\\"quote\\/\\u00e9\"", "\"unterminated",
+      "  \t\n\r {\"a\" : 1 , \"b\":[ 1 ,2 ,, 3, ], \"c\":{}}  trailing", "{\"a\":1,\"a\":2}", "{,\"a\":1,}",
+      "[1 2 3]", "[1-2]", "{\"a\" 1}", "{a:1}", "[nul]", "[truex]", "[trues]", "[nulls,x\\ty z]", "tru", "nullnull",
+      "[\"a\",]", "{\"k\":[{\"k\":[{\"k\":\"v\"}]}]}", "[1,{]", "[\"a\\", "[", "{", "[12abc:/d e]", "[-x]",
+      std::string( "{\"a\":\"b\0\"}", 10 ), "[\"\x04\"]", "\"\xc3\xa9t\xc3\xa9\"", "[\xff]", "+1", "[\x04]",
+      "{\"id\":1,\"method\":\"call\",\"params\":[\"database_api\",\"get_dynamic_global_properties\",[]]}"
+   };
+   for( const auto& json : corpus )
+   {
+      std::string expected;
+      try { expected = typed_dump( fc::json::from_string( json ) ); }
+      catch( const fc::exception& e ) { expected = std::string( "exception " ) + e.name(); }
+      for( size_t chunk : { size_t(1), size_t(2), size_t(3), size_t(7), json.size() + 1 } )
+      {
+         const std::string actual = push_first( json, chunk );
+         BOOST_CHECK_MESSAGE( expected == actual, "for " + json + ": " + expected + " != " + actual );
+      }
+   }
+
+   // consecutive messages, split anywhere
+   fc::mutable_variant_object big;
+   for( int i = 0; i < 100; ++i )
+      big( "key" + fc::to_string( int64_t(i) ), fc::variants{ fc::variant( i ), fc::variant( i * 0.5 ), fc::variant(),
+                                                              fc::variant( std::string( size_t(i), 'a' ) + "\"\\\n" ) } );
+   const std::string message = fc::json::to_string( fc::variant( big ) );
+   const std::string stream = message + "\n" + message + "[1,2]" + message + " 42";
+   for( size_t chunk : { size_t(1), size_t(5), size_t(64), size_t(1000), stream.size() } )
+   {
+      fc::json_push_parser parser;
+      fc::variants values;
+      for( size_t i = 0; i < stream.size(); i += chunk )
+         for( auto& v : parser.feed( stream.data() + i, std::min( chunk, stream.size() - i ) ) )
+            values.push_back( std::move( v ) );
+      BOOST_CHECK( !parser.idle() );
+      BOOST_CHECK_EQUAL( parser.finish().size(), 1u );
+      BOOST_CHECK( parser.idle() );
+      BOOST_REQUIRE_EQUAL( values.size(), 4u );
+      BOOST_CHECK_EQUAL( fc::json::to_string( values[0] ), message );
+      BOOST_CHECK_EQUAL( fc::json::to_string( values[1] ), message );
+      BOOST_CHECK_EQUAL( fc::json::to_string( values[2] ), "[1,2]" );
+      BOOST_CHECK_EQUAL( fc::json::to_string( values[3] ), message );
+   }
+
+   // istream input, as from a buffered_istream or a tcp_socket
+   fc::stringstream in( message + message );
+   fc::json_push_parser parser;
+   size_t received = 0;
+   try { while( true ) received += parser.feed( in ).size(); }
+   catch( const fc::eof_exception& ) {}
+   BOOST_CHECK_EQUAL( received, 2u );
+
+   // limits apply to every message on its own, an unfinished string is checked as it grows
+   fc::parse_limits limits;
+   limits.max_bytes = fc::estimated_size( fc::json::from_string( message ) );
+   fc::json_push_parser limited( fc::json::legacy_parser, limits );
+   BOOST_CHECK_EQUAL( limited.feed( stream.data(), message.size() * 2 + 1 ).size(), 2u );
+   limits.max_depth = 1;
+   fc::json_push_parser shallow( fc::json::legacy_parser, limits );
+   BOOST_CHECK_EQUAL( shallow.feed( "[1][2]", 6 ).size(), 2u );
+   BOOST_CHECK_THROW( shallow.feed( "[[1]]", 5 ), fc::assert_exception );
+   shallow.reset();
+   BOOST_CHECK_THROW( shallow.feed( ( "\"" + std::string( limits.max_bytes, 'x' ) ).c_str(), limits.max_bytes + 1 ), fc::assert_exception );
+   shallow.reset();
+   BOOST_CHECK_EQUAL( shallow.feed( "{}", 2 ).size(), 1u );
+}
+
+namespace {
+   /** writes the events of a document one per line */
+   struct event_trace : fc::json_sax_handler
+   {
+      virtual void on_null() override                  { trace += "null\n"; }
+      virtual void on_bool( bool b ) override          { trace += b ? "true\n" : "false\n"; }
+      virtual void on_int64( int64_t i ) override      { trace += "int64 " + fc::to_string( i ) + "\n"; }
+      virtual void on_uint64( uint64_t i ) override    { trace += "uint64 " + fc::to_string( i ) + "\n"; }
+      virtual void on_double( double d ) override      { trace += "double " + fc::variant( d ).as_string() + "\n"; }
+      virtual void on_string( std::string&& s ) override { trace += "string " + s + "\n"; }
+      virtual void on_start_object() override          { trace += "{\n"; }
+      virtual void on_key( std::string&& key ) override { trace += "key " + key + "\n"; }
+      virtual void on_end_object() override            { trace += "}\n"; }
+      virtual void on_start_array() override           { trace += "[\n"; }
+      virtual void on_end_array() override             { trace += "]\n"; }
+
+      std::string trace;
+   };
+}
+
+BOOST_AUTO_TEST_CASE(sax_events_and_subtrees)
+{
+   const std::string json = "{\"a\":[null,true,false,-1,2,0.5,\"s\"],\"b\":{\"c\":nulls}}";
+   for( size_t chunk : { size_t(1), size_t(3), json.size() } )
+   {
+      event_trace events;
+      fc::json_sax_parser parser( events );
+      for( size_t i = 0; i < json.size(); i += chunk )
+         parser.feed( json.data() + i, std::min( chunk, json.size() - i ) );
+      BOOST_CHECK( parser.idle() );
+      BOOST_CHECK_EQUAL( events.trace, "{\nkey a\n[\nnull\ntrue\nfalse\nint64 -1\nuint64 2\ndouble 0.50000000000000000\n"
+                                       "string s\n]\nkey b\n{\nkey c\nstring nulls\n}\n}\n" );
+   }
+   event_trace doubles;
+   fc::json_sax_parser::parse( "[1.5]", 5, doubles, fc::json::legacy_parser_with_string_doubles );
+   BOOST_CHECK_EQUAL( doubles.trace, "[\nstring 1.5\n]\n" );
+
+   // a large array read one element at a time matches the parsed document
+   fc::variants blocks;
+   for( int i = 0; i < 1000; ++i )
+      blocks.push_back( fc::mutable_variant_object( "height", i )( "ops", fc::variants{ fc::variant( "transfer" ), fc::variant( i * 2 ) } ) );
+   const std::string doc = fc::json::to_string( fc::mutable_variant_object( "blocks", blocks )( "count", 1000 ) );
+   fc::variants read;
+   fc::json_subtree_reader::read( doc.data(), doc.size(), 2, [&]( fc::variant&& v ) { read.push_back( std::move( v ) ); } );
+   BOOST_REQUIRE_EQUAL( read.size(), 1000u );
+   BOOST_CHECK_EQUAL( fc::json::to_string( read ), fc::json::to_string( blocks ) );
+
+   // from an istream, with limits on each element rather than on the document
+   fc::parse_limits limits;
+   limits.max_bytes = 2 * fc::estimated_size( blocks.back() );
+   limits.max_depth = 2;
+   fc::stringstream in( doc );
+   size_t count = 0;
+   fc::json_subtree_reader::read( in, 2, [&]( fc::variant&& v ) { BOOST_CHECK( v.is_object() ); ++count; }, limits );
+   BOOST_CHECK_EQUAL( count, 1000u );
+   limits.max_depth = 1;
+   BOOST_CHECK_THROW( fc::json_subtree_reader::read( doc.data(), doc.size(), 2, []( fc::variant&& ) {}, limits ), fc::assert_exception );
+
+   // the top level values of a stream, at depth 0
+   count = 0;
+   fc::json_subtree_reader::read( "1 [2] {}", 8, 0, [&]( fc::variant&& ) { ++count; } );
+   BOOST_CHECK_EQUAL( count, 3u );
+   BOOST_CHECK_THROW( fc::json_subtree_reader::read( "[1,", 3, 1, []( fc::variant&& ) {} ), fc::eof_exception );
+}
+
+BOOST_AUTO_TEST_CASE(is_valid_allocates_nothing_per_token)
+{
+   // long keys, strings, numbers and words, which would each need an allocation to be kept; doubles
+   // of more than 19 significant digits are left out, lexical_cast allocates to convert them
+   auto document = []( size_t members, fc::json::parse_type ptype )
+   {
+      std::string doc = "[";
+      for( size_t i = 0; i < members; ++i )
+      {
+         doc += i ? ",{" : "{";
+         doc += "\"a key longer than a short string\":\"a value longer than a short string\\n\",";
+         doc += "\"n\":18446744073709551615,\"b\":[true,false,null]";
+         if( ptype != fc::json::strict_parser )
+            doc += ",\"d\":-1234567.12345678,\"w\":total_word_longer_than_a_short_string";
+         doc += "}";
+      }
+      return doc + "]";
+   };
+   for( auto ptype : { fc::json::legacy_parser, fc::json::legacy_parser_with_string_doubles,
+                       fc::json::strict_parser, fc::json::relaxed_parser } )
+   {
+      const std::string one = document( 1, ptype );
+      const std::string many = document( 1000, ptype );
+      size_t offset = 0;
+
+      size_t before = fc_json_test::allocations;
+      const bool one_valid = fc::json::is_valid( one, offset, ptype );
+      const size_t for_one = fc_json_test::allocations - before;
+
+      before = fc_json_test::allocations;
+      const bool many_valid = fc::json::is_valid( many, offset, ptype );
+      const size_t for_many = fc_json_test::allocations - before;
+
+      const std::string parser = fc::to_string( int64_t(ptype) );
+      BOOST_CHECK_MESSAGE( one_valid && many_valid, "parser " + parser );
+      BOOST_CHECK_MESSAGE( for_many == for_one, "parser " + parser + ": " + fc::to_string( uint64_t(for_one) ) +
+                                                " allocations for one member, " + fc::to_string( uint64_t(for_many) ) + " for 1000" );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(is_valid_reports_error_offset)
+{
+   const std::vector<std::string> corpus = {
+      "{}", "[]", "null", "1", "1 ", "-", "-.", "1.5", "1.2.3", "18446744073709551616", "-9223372036854775809",
+      "\"a\\\"b\"", "\"open", "{\"a\":1,\"b\":[1,,2,],}", "{a:1}", "{'a':1}", "{a :1}", "[nulls,x\\ty z]", "[truex]",
+      "0x1F", "0b", "0b1", "+1", "1e5", "1e", "1.", "'s'", "\"\"", "\"\"\"a\"\"b\"\"\"", "r", "{r'raw\\':1}", "[1,{]",
+      "  ", "[\x04]", "[\xff]", "\"\x04\"", std::string( "1\0", 2 ), "{\"a\":1} x", "[1e400]"
+   };
+   for( const auto& json : corpus )
+      for( auto ptype : { fc::json::legacy_parser, fc::json::strict_parser, fc::json::relaxed_parser,
+                          fc::json::legacy_parser_with_string_doubles } )
+      {
+         bool expected;
+         try { expected = fc::json::is_valid( json, ptype ); }
+         catch( const fc::exception& ) { expected = false; }
+         size_t offset = 0;
+         BOOST_CHECK_MESSAGE( fc::json::is_valid( json, offset, ptype ) == expected, json + " with parser " + fc::to_string( int64_t(ptype) ) );
+      }
+
+   size_t offset = 0;
+   BOOST_CHECK( !fc::json::is_valid( "", offset ) );
+   BOOST_CHECK_EQUAL( offset, 0u );
+   BOOST_CHECK( !fc::json::is_valid( "{\"a\":[1,2],\"b\":?}", offset ) );
+   BOOST_CHECK_EQUAL( offset, 15u );
+   BOOST_CHECK( !fc::json::is_valid( "[1,2", offset ) );
+   BOOST_CHECK_EQUAL( offset, 4u );
+   BOOST_CHECK( !fc::json::is_valid( "[1,18446744073709551616]", offset ) );
+   BOOST_CHECK_EQUAL( offset, 3u );
+   BOOST_CHECK( !fc::json::is_valid( "{} {}", offset ) );
+   BOOST_CHECK_EQUAL( offset, 2u );
+
+   // nesting that would overflow the stack of the recursive parsers
+   const std::string deep = std::string( 100000, '[' ) + std::string( 100000, ']' );
+   BOOST_CHECK( !fc::json::is_valid( deep, offset ) );
+   BOOST_CHECK_EQUAL( offset, 16u * 1024 );
+   BOOST_CHECK( fc::json::is_valid( std::string( 1000, '[' ) + std::string( 1000, ']' ), offset ) );
+}
+
+BOOST_AUTO_TEST_CASE(from_file_matches_from_string)
+{
+   fc::temp_file file;
+   const auto parse_file = [&]( const std::string& json, fc::json::parse_type ptype ) -> std::string
+   {
+      {
+         fc::ofstream o( file.path() );
+         o.write( json.data(), json.size() );
+      }
+      try { return typed_dump( fc::json::from_file( file.path(), ptype ) ); }
+      catch( const fc::exception& e ) { return std::string( "exception " ) + e.name(); }
+   };
+   const auto parse_string = []( const std::string& json, fc::json::parse_type ptype ) -> std::string
+   {
+      try { return typed_dump( fc::json::from_string( json, ptype ) ); }
+      catch( const fc::exception& e ) { return std::string( "exception " ) + e.name(); }
+   };
+
+   fc::mutable_variant_object big;
+   for( int i = 0; i < 300; ++i )
+      big( "key" + fc::to_string( int64_t(i) ), fc::variants{ fc::variant( i ), fc::variant( i * 0.25 ),
+                                                              fc::variant( std::string( size_t(i % 90), 'q' ) + "\"\\" ) } );
+   const std::vector<std::string> docs = { fc::json::to_string( big ), fc::json::to_pretty_string( big ),
+                                           "{\"a\":[1,2,{\"b\":null}],\"c\":\"d\"}  ", "[1,2", "{a:1}", "\"open", " " };
+   for( const auto& json : docs )
+      for( auto ptype : { fc::json::legacy_parser, fc::json::strict_parser, fc::json::relaxed_parser,
+                          fc::json::legacy_parser_with_string_doubles, fc::json::structural_parser } )
+         BOOST_CHECK_EQUAL( parse_file( json, ptype ), parse_string( json, ptype ) );
+
+   fc::json::save_to_file( big, file.path() );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::json::from_file( file.path() ) ), fc::json::to_string( big ) );
+
+   fc::remove( file.path() );
+   BOOST_CHECK_THROW( fc::json::from_file( file.path() ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE(extractor_matches_full_parse)
+{
+   // what the extractor should find, looked up in the fully parsed document
+   const auto lookup = []( const fc::variant& doc, const fc::json_extractor::path& path ) -> std::string
+   {
+      const fc::variant* v = &doc;
+      for( const auto& key : path )
+      {
+         if( v->is_object() && v->get_object().contains( key.c_str() ) )
+            v = &v->get_object()[key];
+         else if( v->is_array() && !key.empty() && key.find_first_not_of( "0123456789" ) == std::string::npos
+                  && std::stoul( key ) < v->size() )
+            v = &(*v)[ std::stoul( key ) ];
+         else
+            return "missing";
+      }
+      return typed_dump( *v );
+   };
+
+   const std::vector<fc::json_extractor::path> paths = {
+      {}, { "id" }, { "method" }, { "params", "0" }, { "params", "2", "x" }, { "params", "9" },
+      { "a\tb" }, { "nested", "list", "1", "deep" }, { "method", "0" }, { "" }
+   };
+   const fc::json_extractor extractor( paths );
+
+   const std::vector<std::string> docs = {
+      "{\"id\":7,\"method\":\"call\",\"params\":[\"db\",\"get\",{\"x\":[1,{\"y\":\"]}\"}],\"z\":2}]}",
+      " { \"jsonrpc\" : \"2.0\" , \"params\" : [ [\"}\\\"\", {}] , 2 , {\"x\":-1.5e3} ] , \"id\" : \"abc\" } ",
+      "{\"method\":1,\"method\":[2],\"params\":{\"0\":true}}",
+      "{\"params\":[1,,,{\"x\":1}],\"params\":[3],\"id\":{\"a\":1}}",
+      "{\"a\\tb\":\"tab\",\"\":null,\"nested\":{\"list\":[0,{\"deep\":{\"k\":[\"\\\\\"]}}]}}",
+      "[1,2,3]",
+      "\"top\"",
+      "12345"
+   };
+   for( const auto& json : docs )
+   {
+      const fc::variant doc = fc::json::from_string( json );
+      const fc::variants values = extractor.values( json );
+      const auto slices = extractor.slices( json.data(), json.size() );
+      BOOST_REQUIRE_EQUAL( values.size(), paths.size() );
+      for( size_t i = 0; i < paths.size(); ++i )
+      {
+         const std::string expected = lookup( doc, paths[i] );
+         BOOST_CHECK_MESSAGE( ( slices[i].found() ? typed_dump( values[i] ) : "missing" ) == expected,
+                              json + " at path " + fc::to_string( int64_t(i) ) );
+      }
+   }
+
+   // slices are the text of the values, subtrees included
+   const std::string json = "{\"id\": 42 ,\"params\":[ {\"a\" : [1, \"]\"]} ,\"s\"],\"method\":\"x\"}";
+   const auto slices = extractor.slices( json.data(), json.size() );
+   BOOST_CHECK_EQUAL( slices[0].str(), json );
+   BOOST_CHECK_EQUAL( slices[1].str(), "42" );
+   BOOST_CHECK_EQUAL( slices[2].str(), "\"x\"" );
+   BOOST_CHECK_EQUAL( slices[3].str(), "{\"a\" : [1, \"]\"]}" );
+   BOOST_CHECK( !slices[5].found() );
+   BOOST_CHECK( slices[5].parse().is_null() );
+
+   // only the parts that are read have to be well formed
+   const fc::json_extractor id( { { "id" } } );
+   const std::string broken_tail = "{\"id\":1,\"params\":[";
+   BOOST_CHECK_THROW( id.slices( broken_tail.data(), broken_tail.size() ), fc::parse_error_exception );
+   const std::string unquoted = "{id:1}";
+   BOOST_CHECK_THROW( id.slices( unquoted.data(), unquoted.size() ), fc::parse_error_exception );
+   const std::string open_string = "{\"id\":\"1}";
+   BOOST_CHECK_THROW( id.slices( open_string.data(), open_string.size() ), fc::parse_error_exception );
+
+   BOOST_CHECK_THROW( fc::json_extractor( std::vector<fc::json_extractor::path>( 65 ) ), fc::assert_exception );
+}
+
+BOOST_AUTO_TEST_CASE(number_conversion_matches_lexical_cast)
+{
+   // the result of a conversion, bit for bit, or the exception it throws
+   const auto outcome = []( const std::function<fc::variant()>& convert ) -> std::string
+   {
+      try
+      {
+         const fc::variant v = convert();
+         if( v.is_double() )
+         {
+            const double d = v.as_double();
+            uint64_t bits;
+            memcpy( &bits, &d, sizeof(bits) );
+            return "double " + fc::to_string( bits );
+         }
+         return typed_dump( v );
+      }
+      catch( const fc::exception& e ) { return std::string( "exception " ) + e.name(); }
+   };
+
+   const std::vector<std::string> numbers = {
+      "0", "-0", "7", "-7", "007", "18446744073709551615", "18446744073709551616", "99999999999999999999",
+      "9223372036854775807", "-9223372036854775808", "-9223372036854775809", "00000000000000000000001",
+      "-", "", "1.", ".5", "-.5", "-0.0", "0.1", "1234.5678", "-98765.4321", "0.30000000000000004",
+      "9007199254740993.0", "9007199254740992.0", "1.7976931348623157e308", "2.2250738585072014e-308",
+      "4.9e-324", "1e400", "1e-400", "123456789012345678901234567890.5", "0.000000000000000000000000001",
+      "1e22", "1e23", "1.5e-22", "12e30", "3.14159265358979323846", "1e", "1e+", "1.2.3", "+1.5", "1x", "inf", "nan"
+   };
+   for( const auto& n : numbers )
+   {
+      const char* b = n.data();
+      const char* e = b + n.size();
+      BOOST_CHECK_MESSAGE( outcome( [&]() { return fc::variant( fc::json_number::to_double( b, e ) ); } )
+                           == outcome( [&]() { return fc::variant( fc::to_double( n ) ); } ), "to_double " + n );
+      BOOST_CHECK_MESSAGE( outcome( [&]() { return fc::variant( fc::json_number::to_int64( b, e ) ); } )
+                           == outcome( [&]() { return fc::variant( fc::to_int64( n ) ); } ), "to_int64 " + n );
+      BOOST_CHECK_MESSAGE( outcome( [&]() { return fc::variant( fc::json_number::to_uint64( b, e ) ); } )
+                           == outcome( [&]() { return fc::variant( fc::to_uint64( n ) ); } ), "to_uint64 " + n );
+   }
+
+   // and the parsers read them as the string conversions do
+   const std::vector<std::string> tokens = { "1.5", "-2", "3", "0.1", "-0.0", "18446744073709551615", "-.5", ".25",
+                                             "1234.5678", "-9223372036854775808", "0.30000000000000004" };
+   std::string doc = "[";
+   for( const auto& t : tokens )
+      doc += t + ",";
+   doc.back() = ']';
+   for( auto ptype : { fc::json::legacy_parser, fc::json::structural_parser } )
+   {
+      const fc::variants parsed = fc::json::from_string( doc, ptype ).get_array();
+      BOOST_REQUIRE_EQUAL( parsed.size(), tokens.size() );
+      for( size_t i = 0; i < tokens.size(); ++i )
+      {
+         const std::string& t = tokens[i];
+         const std::string expected = outcome( [&]() {
+            if( t.find( '.' ) != std::string::npos )
+               return fc::variant( fc::to_double( t ) );
+            return t[0] == '-' ? fc::variant( fc::to_int64( t ) ) : fc::variant( fc::to_uint64( t ) );
+         });
+         BOOST_CHECK_EQUAL( outcome( [&]() { return parsed[i]; } ), expected );
+      }
+   }
+   for( auto ptype : { fc::json::strict_parser, fc::json::relaxed_parser } )
+      for( const std::string t : { "1e5", "2E-3", "-125e+2", "1e400" } )
+         BOOST_CHECK_EQUAL( outcome( [&]() { return fc::json::from_string( "[" + t + "]", ptype ).get_array()[0]; } ),
+                            outcome( [&]() { return fc::variant( fc::to_double( t ) ); } ) );
+   BOOST_CHECK_THROW( fc::json::from_string( "[-9223372036854775809]" ), fc::parse_error_exception );
+}
+
+BOOST_AUTO_TEST_CASE(parallel_writer_and_ndjson)
+{
+   fc::variants rows;
+   for( uint32_t i = 0; i < 10000; ++i )
+      rows.emplace_back( fc::mutable_variant_object( "id", i )( "memo", "line\nwith \"escapes\"" )( "amount", int64_t(i) * 1000 - 7 ) );
+   fc::mutable_variant_object wide;
+   for( int i = 0; i < 5000; ++i )
+      wide( "key" + fc::to_string( int64_t(i) ), fc::variants{ fc::variant( i ), fc::variant( i * 0.5 ) } );
+   const fc::variant doc = fc::mutable_variant_object( "rows", rows )( "wide", wide )( "small", fc::variants{ fc::variant( 1 ) } )
+                                                     ( "empty", fc::variants() );
+
+   for( auto format : { fc::json::stringify_large_ints_and_doubles, fc::json::legacy_generator } )
+   {
+      const std::string serial = fc::json::to_string( doc, format );
+      for( uint32_t threads : { 1, 3 } )
+      {
+         BOOST_CHECK( fc::json::to_string_parallel( doc, format, threads ) == serial );
+         fc::stringstream out;
+         fc::json::to_stream_parallel( out, doc, format, threads );
+         BOOST_CHECK( out.str() == serial );
+      }
+   }
+
+   std::string expected;
+   for( const auto& row : rows )
+      expected += fc::json::to_string( row ) + "\n";
+   for( uint32_t threads : { 1, 3 } )
+   {
+      const std::string ndjson = fc::json::to_ndjson( rows, fc::json::stringify_large_ints_and_doubles, threads );
+      BOOST_CHECK( ndjson == expected );
+      const fc::variants back = fc::json::variants_from_ndjson( ndjson, fc::json::legacy_parser, threads );
+      BOOST_CHECK( fc::json::to_string( fc::variant( back ) ) == fc::json::to_string( fc::variant( rows ) ) );
+   }
+
+   // blank lines are skipped, errors name their line
+   const fc::variants few = fc::json::variants_from_ndjson( "\n {\"a\":1} \r\n\n[2]\n  \n\"s\"" );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( few ) ), "[{\"a\":1},[2],\"s\"]" );
+   std::string broken = expected;
+   broken.insert( broken.find( "{\"id\":7000," ), "[1,\n" );
+   try
+   {
+      fc::json::variants_from_ndjson( broken, fc::json::legacy_parser, 3 );
+      BOOST_FAIL( "the broken line parsed" );
+   }
+   catch( const fc::exception& e )
+   {
+      BOOST_CHECK( e.to_detail_string().find( "line 7001 of NDJSON" ) != std::string::npos );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,466 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/io/raw_fwd.hpp>
+
+namespace fc_raw_test {
+   /** reflected, but packed by a pack() of its own that is shorter than its members */
+   struct compact_amount
+   {
+      uint32_t                value = 0;
+      uint8_t                 precision = 0;
+   };
+}
+
+// declared ahead of raw.hpp, like the pack() of a type is declared along with the type
+namespace fc { namespace raw {
+   template<typename Stream>
+   inline void pack( Stream& s, const fc_raw_test::compact_amount& a )
+   {
+      fc::raw::pack( s, fc::unsigned_int( a.value ) );
+      fc::raw::pack( s, a.precision );
+   }
+   template<typename Stream>
+   inline void unpack( Stream& s, fc_raw_test::compact_amount& a )
+   {
+      fc::unsigned_int value;
+      fc::raw::unpack( s, value );
+      a.value = value.value;
+      fc::raw::unpack( s, a.precision );
+   }
+} }
+
+#include <fc/io/raw.hpp>
+#include <fc/io/raw_view.hpp>
+#include <fc/io/raw_skip.hpp>
+#include <fc/io/raw_unpack_file.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/shared_buffer.hpp>
+#include <fc/uint128.hpp>
+#include <fc/static_variant.hpp>
+#include <fc/container/flat.hpp>
+#include <fc/variant_object.hpp>
+
+namespace fc_raw_test {
+   struct amount
+   {
+      int64_t  value = 0;
+      uint8_t  precision = 0;
+   };
+
+   static_assert( fc::raw::is_trivially_packed<uint64_t>::value, "integers are their memory" );
+   static_assert( fc::raw::is_trivially_packed<double>::value, "doubles are their memory" );
+   static_assert( fc::raw::is_trivially_packed< fc::array<char,33> >::value, "arrays of bytes are their memory" );
+   static_assert( fc::raw::is_trivially_packed<fc::sha256>::value, "digests are their memory" );
+   static_assert( fc::raw::is_trivially_packed<fc::ripemd160>::value, "digests are their memory" );
+   static_assert( !fc::raw::is_trivially_packed<bool>::value, "bools are checked when unpacked" );
+   static_assert( !fc::raw::is_trivially_packed<amount>::value, "reflected structs are packed by field" );
+
+   enum class side { buy, sell };
+
+   struct order
+   {
+      uint64_t                id = 0;
+      side                    direction = side::buy;
+      fc::time_point_sec      expiration;
+      fc::sha256              digest;
+      fc::array<char,33>      owner;
+   };
+
+   struct named_order : order
+   {
+      std::string             name;
+      std::vector<uint32_t>   fills;
+   };
+
+   struct fill
+   {
+      order                   taken;
+      fc::uint128_t           volume;
+      bool                    partial = false;
+   };
+
+   struct memo
+   {
+      uint64_t                id = 0;
+      std::string             text;
+      std::vector<char>       payload;
+   };
+
+   /** memo, read without copying its text and payload */
+   struct memo_view
+   {
+      uint64_t                id = 0;
+      fc::raw::string_view    text;
+      fc::raw::byte_view      payload;
+   };
+
+   struct record_header
+   {
+      uint32_t                block = 0;
+      fc::time_point_sec      timestamp;
+   };
+
+   /** has a member of each kind skip() moves past differently */
+   struct record : record_header
+   {
+      fc::static_variant<uint64_t, std::string, order>     op;
+      fc::optional<named_order>                             maybe;
+      std::map<std::string, std::vector<uint16_t>>          tags;
+      fc::flat_map<uint32_t, fc::optional<std::string>>     notes;
+      std::set<std::string>                                 names;
+      std::deque<order>                                     orders;
+      std::pair<std::string, uint64_t>                      pair;
+      fc::variant                                           extra;
+      std::string                                           trailer;
+   };
+
+   /** what pack() wrote for a vector or a deque before it copied elements in bulk */
+   template<typename Container>
+   std::vector<char> pack_one_by_one( const Container& value )
+   {
+      std::vector<char> result = fc::raw::pack( fc::unsigned_int( (uint32_t)value.size() ) );
+      for( const auto& e : value )
+      {
+         const std::vector<char> packed = fc::raw::pack( e );
+         result.insert( result.end(), packed.begin(), packed.end() );
+      }
+      return result;
+   }
+
+   template<typename Container>
+   void check_round_trip( const Container& value )
+   {
+      const std::vector<char> packed = fc::raw::pack( value );
+      BOOST_CHECK( packed == pack_one_by_one( value ) );
+      BOOST_CHECK_EQUAL( fc::raw::pack_size( value ), packed.size() );
+      BOOST_CHECK( fc::raw::unpack<Container>( packed ) == value );
+   }
+
+   /** packed after a test run with datastream<size_t>, the way pack() does without a static size */
+   template<typename T>
+   std::vector<char> pack_in_two_passes( const T& v )
+   {
+      fc::datastream<size_t> ps;
+      fc::raw::pack( ps, v );
+      std::vector<char> result( ps.tellp() );
+      fc::datastream<char*> ds( result.data(), result.size() );
+      fc::raw::pack( ds, v );
+      return result;
+   }
+
+   template<typename T>
+   void check_pack( const T& v )
+   {
+      const std::vector<char> expected = pack_in_two_passes( v );
+      BOOST_CHECK( fc::raw::pack( v ) == expected );
+      BOOST_CHECK_EQUAL( fc::raw::pack_size( v ), expected.size() );
+   }
+}
+
+FC_REFLECT( fc_raw_test::amount, (value)(precision) )
+FC_REFLECT_ENUM( fc_raw_test::side, (buy)(sell) )
+FC_REFLECT( fc_raw_test::order, (id)(direction)(expiration)(digest)(owner) )
+FC_REFLECT_DERIVED( fc_raw_test::named_order, (fc_raw_test::order), (name)(fills) )
+FC_REFLECT( fc_raw_test::fill, (taken)(volume)(partial) )
+FC_REFLECT( fc_raw_test::memo, (id)(text)(payload) )
+FC_REFLECT( fc_raw_test::record_header, (block)(timestamp) )
+FC_REFLECT_DERIVED( fc_raw_test::record, (fc_raw_test::record_header),
+                    (op)(maybe)(tags)(notes)(names)(orders)(pair)(extra)(trailer) )
+FC_REFLECT( fc_raw_test::memo_view, (id)(text)(payload) )
+FC_REFLECT( fc_raw_test::compact_amount, (value)(precision) )
+
+namespace fc_raw_test {
+   static_assert( fc::raw::static_pack_size<uint16_t>::is_fixed && fc::raw::static_pack_size<uint16_t>::value == 2, "" );
+   static_assert( fc::raw::static_pack_size<bool>::value == 1, "" );
+   static_assert( fc::raw::static_pack_size<side>::value == 8, "reflected enums are packed as int64_t" );
+   static_assert( fc::raw::static_pack_size<fc::ripemd160>::value == 20, "" );
+   static_assert( fc::raw::static_pack_size<order>::is_fixed && fc::raw::static_pack_size<order>::value == 8 + 8 + 4 + 32 + 33, "" );
+   static_assert( fc::raw::static_pack_size<fill>::value == fc::raw::static_pack_size<order>::value + 16 + 1, "" );
+   static_assert( !fc::raw::static_pack_size<named_order>::is_fixed, "" );
+   static_assert( fc::raw::static_pack_size<amount>::value == 9, "" );
+   static_assert( !fc::raw::static_pack_size<compact_amount>::is_fixed, "a pack() of its own may write other than the members" );
+   static_assert( !fc::raw::static_pack_size<std::string>::is_fixed, "" );
+   static_assert( !fc::raw::static_pack_size< std::vector<uint64_t> >::is_fixed, "" );
+   static_assert( !fc::raw::static_pack_size< fc::optional<uint64_t> >::is_fixed, "" );
+}
+
+BOOST_AUTO_TEST_SUITE(fc_raw)
+
+BOOST_AUTO_TEST_CASE(bulk_copies_match_element_packing)
+{
+   using namespace fc_raw_test;
+
+   std::vector<uint64_t> ids;
+   std::vector<int16_t> deltas;
+   std::deque<uint32_t> heights;
+   std::vector<fc::sha256> hashes;
+   std::vector<fc::ripemd160> ripemds;
+   std::vector< fc::array<char,33> > keys;
+   std::vector<amount> amounts;
+   std::vector<bool> flags;
+   std::deque<bool> deque_flags;
+   for( uint32_t i = 0; i < 3000; ++i )
+   {
+      const std::string s = fc::to_string( uint64_t(i) );
+      ids.push_back( uint64_t(i) * 0x9e3779b97f4a7c15ull );
+      deltas.push_back( int16_t( i * 37 ) );
+      // a deque grown at both ends, so its elements lie in several blocks
+      if( i % 2 )
+         heights.push_back( i );
+      else
+         heights.push_front( i );
+      hashes.push_back( fc::sha256::hash( s ) );
+      ripemds.push_back( fc::ripemd160::hash( s ) );
+      fc::array<char,33> key;
+      for( size_t j = 0; j < key.size(); ++j )
+         key.data[j] = char( i + j );
+      keys.push_back( key );
+      amounts.push_back( amount{ int64_t(i) - 1500, uint8_t(i % 9) } );
+      flags.push_back( i % 3 == 0 );
+      deque_flags.push_back( i % 5 == 0 );
+   }
+
+   check_round_trip( ids );
+   check_round_trip( deltas );
+   check_round_trip( heights );
+   check_round_trip( hashes );
+   check_round_trip( ripemds );
+   check_round_trip( keys );
+   check_round_trip( deque_flags );
+   check_round_trip( std::vector<uint64_t>() );
+   check_round_trip( std::deque<uint32_t>() );
+
+   const std::vector<char> packed_amounts = fc::raw::pack( amounts );
+   BOOST_CHECK( packed_amounts == pack_one_by_one( amounts ) );
+   const auto unpacked_amounts = fc::raw::unpack< std::vector<amount> >( packed_amounts );
+   BOOST_REQUIRE_EQUAL( unpacked_amounts.size(), amounts.size() );
+   BOOST_CHECK_EQUAL( unpacked_amounts.back().value, amounts.back().value );
+   BOOST_CHECK( fc::raw::pack( flags ) == pack_one_by_one( flags ) );
+
+   // the bulk read still stops at the end of the data, and bools are still checked
+   std::vector<char> truncated = fc::raw::pack( hashes );
+   truncated.resize( truncated.size() - 1 );
+   BOOST_CHECK_THROW( fc::raw::unpack< std::vector<fc::sha256> >( truncated ), fc::exception );
+   std::vector<char> bad_bool = fc::raw::pack( deque_flags );
+   bad_bool.back() = 2;
+   BOOST_CHECK_THROW( fc::raw::unpack< std::deque<bool> >( bad_bool ), fc::assert_exception );
+}
+
+BOOST_AUTO_TEST_CASE(static_sizes_and_growable_streams)
+{
+   using namespace fc_raw_test;
+
+   order o;
+   o.id = 42;
+   o.direction = side::sell;
+   o.expiration = fc::time_point_sec( 1500000000 );
+   o.digest = fc::sha256::hash( std::string( "order" ) );
+   for( size_t i = 0; i < o.owner.size(); ++i )
+      o.owner.data[i] = char( i * 7 );
+   named_order n;
+   static_cast<order&>( n ) = o;
+   n.name = std::string( 300, 'n' );
+   for( uint32_t i = 0; i < 1000; ++i )
+      n.fills.push_back( i * 3 );
+   fill f{ o, fc::uint128_t( 7, 11 ), true };
+
+   check_pack( uint64_t( 7 ) );
+   check_pack( o );
+   check_pack( n );
+   check_pack( f );
+   check_pack( std::string() );
+   check_pack( std::vector<named_order>( 50, n ) );
+   check_pack( compact_amount{ 5, 3 } );
+   check_pack( compact_amount{ 100000, 3 } );
+   BOOST_CHECK_EQUAL( fc::raw::pack_size( compact_amount{ 5, 3 } ), 2u );
+   BOOST_CHECK_EQUAL( fc::raw::unpack<named_order>( fc::raw::pack( n ) ).fills.size(), n.fills.size() );
+
+   // the stream appends to what the container already holds, and cuts it back when it goes
+   std::string text = "head";
+   {
+      fc::growable_datastream<std::string> ds( text, 16 );
+      for( uint32_t i = 0; i < 20; ++i )
+         fc::raw::pack( ds, n );
+      fc::raw::pack( ds, o );
+      BOOST_CHECK_EQUAL( ds.tellp(), 20 * fc::raw::pack_size( n ) + fc::raw::pack_size( o ) );
+   }
+   BOOST_REQUIRE_EQUAL( text.size(), 4 + 20 * fc::raw::pack_size( n ) + fc::raw::pack_size( o ) );
+   BOOST_CHECK( text.substr( 0, 4 ) == "head" );
+   BOOST_CHECK( std::vector<char>( text.begin() + 4, text.begin() + 4 + fc::raw::pack_size( n ) ) == pack_in_two_passes( n ) );
+   BOOST_CHECK( std::vector<char>( text.end() - fc::raw::pack_size( o ), text.end() ) == pack_in_two_passes( o ) );
+   std::vector<char> empty;
+   {
+      fc::growable_datastream< std::vector<char> > ds( empty );
+   }
+   BOOST_CHECK( empty.empty() );
+
+   fc::temp_file file;
+   boost::interprocess::managed_mapped_file segment( boost::interprocess::create_only, file.path().generic_string().c_str(), 1024 * 1024 );
+   fc::shared_buffer buffer( fc::shared_allocator<char>( segment.get_segment_manager() ) );
+   fc::raw::pack( buffer, n );
+   BOOST_CHECK( std::vector<char>( buffer.begin(), buffer.end() ) == pack_in_two_passes( n ) );
+   BOOST_CHECK_EQUAL( fc::raw::unpack<named_order>( buffer ).name, n.name );
+   fc::raw::pack( buffer, o );
+   BOOST_CHECK( std::vector<char>( buffer.begin(), buffer.end() ) == pack_in_two_passes( o ) );
+}
+
+BOOST_AUTO_TEST_CASE(views_point_into_the_packed_data)
+{
+   using namespace fc_raw_test;
+
+   std::vector<memo> memos;
+   for( uint32_t i = 0; i < 100; ++i )
+      memos.push_back( memo{ i, "memo " + std::string( i, 'm' ), std::vector<char>( i * 3, char(i) ) } );
+   const std::vector<char> packed = fc::raw::pack( memos );
+
+   const auto views = fc::raw::unpack< std::vector<memo_view> >( packed );
+   BOOST_REQUIRE_EQUAL( views.size(), memos.size() );
+   for( size_t i = 0; i < memos.size(); ++i )
+   {
+      BOOST_CHECK_EQUAL( views[i].id, memos[i].id );
+      BOOST_CHECK_EQUAL( views[i].text.str(), memos[i].text );
+      BOOST_CHECK( views[i].text == fc::raw::string_view( memos[i].text ) );
+      BOOST_CHECK( views[i].payload.to_vector() == memos[i].payload );
+      BOOST_CHECK( views[i].text.data() >= packed.data() && views[i].text.end() <= packed.data() + packed.size() );
+      BOOST_CHECK( views[i].payload.empty() || ( views[i].payload.data() > views[i].text.data()
+                                               && views[i].payload.end() <= packed.data() + packed.size() ) );
+   }
+   // views pack to the same bytes as what they were unpacked from
+   BOOST_CHECK( fc::raw::pack( views ) == packed );
+
+   // a length past the end, or past the limit of vectors, is rejected like for a vector
+   std::vector<char> truncated = fc::raw::pack( std::string( 100, 't' ) );
+   truncated.resize( truncated.size() - 1 );
+   BOOST_CHECK_THROW( fc::raw::unpack<fc::raw::string_view>( truncated ), fc::out_of_range_exception );
+   BOOST_CHECK_THROW( fc::raw::unpack<fc::raw::byte_view>( fc::raw::pack( fc::unsigned_int( MAX_ARRAY_ALLOC_SIZE ) ) ),
+                      fc::assert_exception );
+   BOOST_CHECK( fc::raw::unpack<fc::raw::byte_view>( fc::raw::pack( std::vector<char>() ) ).empty() );
+
+   fc::temp_file file;
+   {
+      fc::ofstream out( file.path() );
+      out.write( packed.data(), packed.size() );
+   }
+   fc::file_mapping mapping( file.path().generic_string().c_str(), fc::read_only );
+   fc::mapped_region region( mapping, fc::read_only, 0, packed.size() );
+   std::vector<memo_view> mapped;
+   fc::raw::unpack_region( region, mapped );
+   BOOST_REQUIRE_EQUAL( mapped.size(), memos.size() );
+   BOOST_CHECK_EQUAL( mapped.back().text.str(), memos.back().text );
+   BOOST_CHECK( mapped.back().text.data() > (const char*)region.get_address() );
+}
+
+BOOST_AUTO_TEST_CASE(skip_and_unpack_members)
+{
+   using namespace fc_raw_test;
+
+   order o;
+   o.id = 7;
+   o.expiration = fc::time_point_sec( 1500000000 );
+   named_order n;
+   n.name = "named";
+   n.fills = { 1, 2, 3 };
+
+   std::vector<record> records( 30 );
+   for( uint32_t i = 0; i < records.size(); ++i )
+   {
+      record& r = records[i];
+      r.block = 1000 + i;
+      r.timestamp = fc::time_point_sec( 1500000000 + i * 3 );
+      if( i % 3 == 0 )
+         r.op = uint64_t( i );
+      else if( i % 3 == 1 )
+         r.op = std::string( i, 'o' );
+      else
+         r.op = o;
+      if( i % 2 )
+         r.maybe = n;
+      r.tags[ "tag" ] = std::vector<uint16_t>( i, 5 );
+      r.notes[ i ] = fc::optional<std::string>();
+      r.notes[ i + 1 ] = std::string( "note" );
+      r.names = { "a", std::string( i, 'b' ) };
+      r.orders = std::deque<order>( i % 4, o );
+      r.pair = std::make_pair( std::string( "key" ), uint64_t( i ) );
+      r.extra = fc::mutable_variant_object( "i", i )( "s", "text" );
+      r.trailer = "end " + fc::to_string( uint64_t(i) );
+   }
+   const std::vector<char> packed = fc::raw::pack( records );
+
+   // skipping a record lands where unpacking it does
+   {
+      fc::datastream<const char*> ds( packed.data(), packed.size() );
+      fc::unsigned_int count;
+      fc::raw::unpack( ds, count );
+      for( uint32_t i = 0; i < count.value; ++i )
+      {
+         fc::datastream<const char*> copy = ds;
+         record r;
+         fc::raw::unpack( copy, r );
+         fc::raw::skip<record>( ds );
+         BOOST_CHECK_EQUAL( ds.tellp(), copy.tellp() );
+      }
+      BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+   }
+   {
+      fc::datastream<const char*> ds( packed.data(), packed.size() );
+      fc::raw::skip< std::vector<record> >( ds );
+      BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+   }
+
+   // only the selected members are filled in, base members included
+   {
+      fc::datastream<const char*> ds( packed.data(), packed.size() );
+      fc::unsigned_int count;
+      fc::raw::unpack( ds, count );
+      for( uint32_t i = 0; i < count.value; ++i )
+      {
+         record r;
+         fc::raw::unpack_members( ds, r, &record::timestamp, &record::op, &record::trailer );
+         BOOST_CHECK( r.timestamp == records[i].timestamp );
+         BOOST_CHECK_EQUAL( r.op.which(), records[i].op.which() );
+         BOOST_CHECK_EQUAL( r.trailer, records[i].trailer );
+         BOOST_CHECK_EQUAL( r.block, 0u );
+         BOOST_CHECK( r.tags.empty() );
+         BOOST_CHECK( !r.maybe.valid() );
+      }
+      BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+   }
+
+   // a type with a pack() of its own is skipped by unpacking it
+   {
+      const std::vector<compact_amount> amounts = { { 5, 3 }, { 100000, 2 }, { 7, 0 } };
+      const std::vector<char> packed_amounts = fc::raw::pack( amounts );
+      fc::datastream<const char*> ds( packed_amounts.data(), packed_amounts.size() );
+      fc::raw::skip< std::vector<compact_amount> >( ds );
+      BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+   }
+
+   // a bad tag or a short buffer is noticed while skipping
+   std::vector<char> bad_tag = fc::raw::pack( fc::static_variant<uint64_t, std::string>( uint64_t(1) ) );
+   bad_tag[0] = 5;
+   fc::datastream<const char*> bad( bad_tag.data(), bad_tag.size() );
+   BOOST_CHECK_THROW( ( fc::raw::skip< fc::static_variant<uint64_t, std::string> >( bad ) ), fc::assert_exception );
+   std::vector<char> truncated = fc::raw::pack( records.back() );
+   truncated.resize( truncated.size() - 1 );
+   fc::datastream<const char*> short_ds( truncated.data(), truncated.size() );
+   BOOST_CHECK_THROW( fc::raw::skip<record>( short_ds ), fc::exception );
+
+   // a length unpack() would refuse to allocate for is refused by skip() too, before reading on
+   std::vector<char> hostile = fc::raw::pack( fc::unsigned_int( MAX_ARRAY_ALLOC_SIZE / sizeof(uint64_t) ) );
+   hostile.resize( hostile.size() + 16 );
+   fc::datastream<const char*> hostile_unpack( hostile.data(), hostile.size() );
+   std::vector<uint64_t> refused;
+   BOOST_CHECK_THROW( fc::raw::unpack( hostile_unpack, refused ), fc::assert_exception );
+   fc::datastream<const char*> hostile_vector( hostile.data(), hostile.size() );
+   BOOST_CHECK_THROW( fc::raw::skip< std::vector<uint64_t> >( hostile_vector ), fc::assert_exception );
+   fc::datastream<const char*> hostile_map( hostile.data(), hostile.size() );
+   BOOST_CHECK_THROW( ( fc::raw::skip< std::map<uint32_t, uint32_t> >( hostile_map ) ), fc::assert_exception );
+   fc::datastream<const char*> hostile_string( hostile.data(), hostile.size() );
+   BOOST_CHECK_THROW( fc::raw::skip<std::string>( hostile_string ), fc::out_of_range_exception );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,423 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/variant.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/variant_arena.hpp>
+#include <fc/variant_limits.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/io/raw_variant.hpp>
+
+#include <thread>
+
+namespace fc_variant_test {
+   struct properties
+   {
+      int64_t     head_block_number = 0;
+      std::string current_witness;
+   };
+}
+FC_REFLECT( fc_variant_test::properties, (head_block_number)(current_witness) )
+
+BOOST_AUTO_TEST_SUITE(fc_variant)
+
+BOOST_AUTO_TEST_CASE(short_and_long_strings)
+{
+   const std::string short_str( "id" );
+   const std::string edge_str( "0123456789abcd" );
+   const std::string long_str( "a string that is too long to be stored inline" );
+
+   for( const auto& str : { std::string(), short_str, edge_str, long_str } )
+   {
+      fc::variant v( str );
+      BOOST_CHECK( v.is_string() );
+      BOOST_CHECK_EQUAL( v.get_type(), fc::variant::string_type );
+      BOOST_CHECK_EQUAL( v.as_string(), str );
+      BOOST_CHECK_EQUAL( std::string( v.string_data(), v.string_size() ), str );
+
+      fc::variant copy( v );
+      BOOST_CHECK_EQUAL( copy.as_string(), str );
+      fc::variant assigned;
+      assigned = copy;
+      BOOST_CHECK_EQUAL( assigned.as_string(), str );
+      fc::variant moved( std::move( copy ) );
+      BOOST_CHECK( copy.is_null() );
+      BOOST_CHECK_EQUAL( moved.as_string(), str );
+
+      // get_string() hands out a reference that stays valid, to the string the variant holds from then on
+      const std::string& ref = v.get_string();
+      BOOST_CHECK_EQUAL( ref, str );
+      BOOST_CHECK_EQUAL( &ref, &v.get_string() );
+      BOOST_CHECK_EQUAL( (const void*)ref.data(), (const void*)v.string_data() );
+      BOOST_CHECK_EQUAL( v.as_string(), str );
+      BOOST_CHECK_EQUAL( fc::variant( v ).get_string(), str );
+
+      std::string tmp;
+      BOOST_CHECK_EQUAL( v.string_value( tmp ), str );
+   }
+   BOOST_CHECK_THROW( fc::variant( 1 ).get_string(), fc::bad_cast_exception );
+
+   BOOST_CHECK_EQUAL( fc::variant( "42" ).as_int64(), 42 );
+   BOOST_CHECK_EQUAL( fc::variant( "true" ).as_bool(), true );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( "a\"b" ) ), "\"a\\\"b\"" );
+   BOOST_CHECK_THROW( fc::variant( 1 ).string_data(), fc::bad_cast_exception );
+}
+
+BOOST_AUTO_TEST_CASE(large_object_lookup)
+{
+   fc::mutable_variant_object mvo;
+   for( int i = 0; i < 100; ++i )
+   {
+      mvo( "key" + fc::to_string( int64_t(i) ), i );
+      BOOST_REQUIRE( mvo.find( "key" + fc::to_string( int64_t(i) ) ) != mvo.end() );
+      BOOST_CHECK_EQUAL( mvo["key0"].as_int64(), 0 );
+   }
+   mvo( "key7", fc::variant( 1000 ) ); // appended duplicates resolve to the first entry
+   mvo.set( "key8", 800 );
+   BOOST_CHECK_EQUAL( mvo["key7"].as_int64(), 7 );
+   BOOST_CHECK_EQUAL( mvo["key8"].as_int64(), 800 );
+   BOOST_CHECK( mvo.find( "missing" ) == mvo.end() );
+
+   mvo.erase( "key50" );
+   BOOST_CHECK( mvo.find( "key50" ) == mvo.end() );
+   BOOST_CHECK_EQUAL( mvo["key51"].as_int64(), 51 );
+
+   fc::variant_object vo( mvo );
+   fc::variant_object copy( vo );
+   for( int i = 0; i < 100; ++i )
+   {
+      auto key = "key" + fc::to_string( int64_t(i) );
+      BOOST_CHECK_EQUAL( vo.find( key ) != vo.end(), i != 50 );
+      BOOST_CHECK_EQUAL( copy.find( key.c_str() ) != copy.end(), i != 50 );
+   }
+   BOOST_CHECK_EQUAL( vo["key7"].as_int64(), 7 );
+
+   // iteration keeps insertion order
+   int64_t expected = 0;
+   for( const auto& e : vo )
+   {
+      if( expected == 50 ) ++expected;
+      if( expected == 100 ) break;
+      BOOST_CHECK_EQUAL( e.key(), "key" + fc::to_string( expected ) );
+      ++expected;
+   }
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_const_lookup)
+{
+   // the first lookup builds the index of a large object, readers of a const object may race to it
+   fc::mutable_variant_object mvo;
+   for( int i = 0; i < 100; ++i )
+      mvo( "key" + fc::to_string( int64_t(i) ), i );
+   const fc::mutable_variant_object& cmvo = mvo;
+   const fc::variant_object vo( mvo );
+
+   std::vector<std::thread> readers;
+   std::vector<int> found( 4, 0 );
+   for( size_t t = 0; t < found.size(); ++t )
+      readers.emplace_back( [&cmvo, &vo, &found, t]()
+      {
+         for( int i = 0; i < 100; ++i )
+         {
+            auto key = "key" + fc::to_string( int64_t(i) );
+            auto itr = cmvo.find( key );
+            if( itr != cmvo.end() && itr->value().as_int64() == i && vo[key].as_int64() == i )
+               ++found[t];
+         }
+      });
+   for( auto& r : readers )
+      r.join();
+   for( int n : found )
+      BOOST_CHECK_EQUAL( n, 100 );
+}
+
+BOOST_AUTO_TEST_CASE(copies_share_until_modified)
+{
+   fc::variants arr{ fc::variant( 1 ), fc::variant( "a string long enough for the heap" ) };
+   fc::variant a( arr );
+   fc::variant b( a );
+
+   const fc::variant& cb = b;
+   fc::variant c( b );
+   BOOST_CHECK_EQUAL( &cb.get_array(), &static_cast<const fc::variant&>(c).get_array() );
+
+   // writing through a mutable reference never shows up in other copies
+   b.get_array().push_back( fc::variant( 3 ) );
+   BOOST_CHECK_EQUAL( a.size(), 2u );
+   BOOST_CHECK_EQUAL( b.size(), 3u );
+   BOOST_CHECK_EQUAL( c.size(), 2u );
+
+   fc::variants& ref = b.get_array();
+   fc::variant d( b );
+   ref.push_back( fc::variant( 4 ) );
+   BOOST_CHECK_EQUAL( b.size(), 4u );
+   BOOST_CHECK_EQUAL( d.size(), 3u );
+
+   fc::variant obj( fc::mutable_variant_object( "x", 1 ) );
+   fc::variant obj_copy;
+   obj_copy = obj;
+   obj.get_object() = fc::mutable_variant_object( "y", 2 );
+   BOOST_CHECK( obj_copy.get_object().contains( "x" ) );
+   BOOST_CHECK( obj.get_object().contains( "y" ) );
+
+   fc::blob bl{ { 'a', 'b' } };
+   fc::variant vb( bl );
+   fc::variant vb_copy( vb );
+   vb.get_blob().data.push_back( 'c' );
+   BOOST_CHECK_EQUAL( vb_copy.get_blob().data.size(), 2u );
+   BOOST_CHECK_EQUAL( vb.get_blob().data.size(), 3u );
+
+   // assigning a variant from a value it owns
+   fc::variant nested( fc::variants{ fc::variant( fc::variants{ fc::variant( 5 ) } ) } );
+   nested = nested.get_array()[0];
+   BOOST_CHECK_EQUAL( nested[size_t(0)].as_int64(), 5 );
+   nested = std::move( nested.get_array()[0] );
+   BOOST_CHECK_EQUAL( nested.as_int64(), 5 );
+}
+
+BOOST_AUTO_TEST_CASE(arena_allocated_tree)
+{
+   const std::string json = "{\"id\":1,\"method\":\"call\",\"params\":[\"database_api\",\"get_dynamic_global_properties\",[]]}";
+   fc::variant kept;
+   {
+      fc::variant_arena arena;
+      fc::variant request = fc::json::from_string( json, arena );
+      const size_t used = arena.allocated_bytes();
+      BOOST_CHECK( used > 0 );
+      BOOST_CHECK_EQUAL( request["method"].as_string(), "call" );
+      BOOST_CHECK_EQUAL( request["params"][size_t(1)].as_string(), "get_dynamic_global_properties" );
+      BOOST_CHECK_EQUAL( fc::json::to_string( request ), json );
+
+      fc::variant copy( request );
+      copy.get_object() = fc::mutable_variant_object( "id", 2 );
+      BOOST_CHECK_EQUAL( request["id"].as_int64(), 1 );
+
+      // only the tree the arena was passed for is allocated from it
+      fc::variant outside = fc::json::from_string( json );
+      fc::variant built( fc::variants{ fc::variant( std::string( 40, 'x' ) ) } );
+      BOOST_CHECK_EQUAL( arena.allocated_bytes(), used );
+
+      fc::variant reflected;
+      fc::to_variant( fc_variant_test::properties{ 7, "a witness with a long name" }, reflected, arena );
+      BOOST_CHECK( arena.allocated_bytes() > used );
+      BOOST_CHECK_EQUAL( reflected["current_witness"].as_string(), "a witness with a long name" );
+
+      kept = request["params"];
+   }
+   // copies of the tree and the errors of a parse outlive the arena
+   BOOST_CHECK_EQUAL( kept[size_t(1)].as_string(), "get_dynamic_global_properties" );
+
+   fc::variant kept_object;
+   {
+      fc::variant_arena arena;
+      fc::variant request = fc::json::from_string(
+         "{\"params\":{\"account\":{\"name\":\"a name long enough to need a payload\",\"keys\":[\"a key long enough to need a payload\"]}}}", arena );
+      kept_object = request["params"];
+   }
+   BOOST_CHECK_EQUAL( kept_object["account"]["name"].as_string(), "a name long enough to need a payload" );
+   BOOST_CHECK_EQUAL( kept_object["account"]["keys"][size_t(0)].as_string(), "a key long enough to need a payload" );
+
+   fc::optional<fc::exception> error;
+   {
+      fc::variant_arena arena;
+      try
+      {
+         fc::json::from_string( "[\"a string long enough to need a payload\", tru", arena );
+      }
+      catch( const fc::exception& e )
+      {
+         error = e;
+      }
+   }
+   BOOST_REQUIRE( error.valid() );
+   BOOST_CHECK( error->to_detail_string().find( "a string long enough to need a payload" ) != std::string::npos );
+}
+
+BOOST_AUTO_TEST_CASE(static_keys)
+{
+   fc_variant_test::properties props;
+   props.head_block_number = 42;
+   props.current_witness = "initdelegate";
+
+   fc::variant a( props );
+   fc::variant b( props );
+   const fc::variant_object& oa = a.get_object();
+   const fc::variant_object& ob = b.get_object();
+   BOOST_CHECK_EQUAL( oa.begin()->key(), "head_block_number" );
+   BOOST_CHECK_EQUAL( oa["head_block_number"].as_int64(), 42 );
+   BOOST_CHECK_EQUAL( ob["current_witness"].as_string(), "initdelegate" );
+   // long reflected names are interned and shared by every object
+   BOOST_CHECK_EQUAL( &oa.begin()->key(), &ob.begin()->key() );
+
+   fc::mutable_variant_object mvo( oa );
+   BOOST_CHECK_EQUAL( &mvo.begin()->key(), &oa.begin()->key() );
+   mvo( fc::static_key( "head_block_number" ), 43 );
+   mvo( fc::static_key( "id" ), 1 );
+   BOOST_CHECK_EQUAL( mvo.size(), 3u );
+   BOOST_CHECK_EQUAL( mvo["head_block_number"].as_int64(), 43 );
+   BOOST_CHECK_EQUAL( mvo["id"].as_int64(), 1 );
+
+   fc_variant_test::properties back = fc::variant( mvo ).as<fc_variant_test::properties>();
+   BOOST_CHECK_EQUAL( back.head_block_number, 43 );
+   BOOST_CHECK_EQUAL( fc::json::to_string( a ), "{\"head_block_number\":42,\"current_witness\":\"initdelegate\"}" );
+}
+
+BOOST_AUTO_TEST_CASE(typed_visit)
+{
+   struct type_name
+   {
+      std::string operator()()const                            { return "null"; }
+      std::string operator()( int64_t )const                   { return "int64"; }
+      std::string operator()( uint64_t )const                  { return "uint64"; }
+      std::string operator()( double )const                    { return "double"; }
+      std::string operator()( bool )const                      { return "bool"; }
+      std::string operator()( const std::string& s )const      { return "string " + s; }
+      std::string operator()( const fc::variants& a )const     { return "array " + fc::to_string( uint64_t(a.size()) ); }
+      std::string operator()( const fc::variant_object& o )const { return "object " + o.begin()->key(); }
+      std::string operator()( const fc::blob& )const           { return "blob"; }
+   };
+
+   BOOST_CHECK_EQUAL( fc::variant().visit( type_name() ), "null" );
+   BOOST_CHECK_EQUAL( fc::variant( int64_t(-1) ).visit( type_name() ), "int64" );
+   BOOST_CHECK_EQUAL( fc::variant( uint64_t(1) ).visit( type_name() ), "uint64" );
+   BOOST_CHECK_EQUAL( fc::variant( 0.5 ).visit( type_name() ), "double" );
+   BOOST_CHECK_EQUAL( fc::variant( true ).visit( type_name() ), "bool" );
+   BOOST_CHECK_EQUAL( fc::variant( "short" ).visit( type_name() ), "string short" );
+   BOOST_CHECK_EQUAL( fc::variant( "a string stored on the heap" ).visit( type_name() ), "string a string stored on the heap" );
+   BOOST_CHECK_EQUAL( fc::variant( fc::variants( 3 ) ).visit( type_name() ), "array 3" );
+   BOOST_CHECK_EQUAL( fc::variant( fc::mutable_variant_object( "k", 1 ) ).visit( type_name() ), "object k" );
+   BOOST_CHECK_EQUAL( fc::variant( fc::blob() ).visit( type_name() ), "blob" );
+   const fc::variant blob_var( fc::blob{ { 'a', 'b', '\0', 'c' } } );
+   BOOST_CHECK_EQUAL( fc::json::to_string( blob_var ), "\"" + blob_var.as_string() + "\"" );
+
+   const fc::variant tree = fc::json::from_string( "{\"a\":[1,{\"b\":\"x\"},[]],\"c\":null}" );
+   std::vector<std::string> nodes;
+   fc::walk_variant( tree, [&]( const fc::variant& v, uint32_t depth )
+   {
+      nodes.push_back( fc::to_string( uint64_t(depth) ) + " " + v.visit( type_name() ) );
+   });
+   const std::vector<std::string> expected{ "0 object a", "1 array 3", "2 uint64", "2 object b", "3 string x",
+                                            "2 array 0", "1 null" };
+   BOOST_CHECK_EQUAL_COLLECTIONS( nodes.begin(), nodes.end(), expected.begin(), expected.end() );
+
+   // the raw packer walks the same tree
+   const auto packed = fc::raw::pack( tree );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::raw::unpack<fc::variant>( packed ) ), fc::json::to_string( tree ) );
+   BOOST_CHECK_THROW( fc::raw::pack( fc::variant( fc::blob() ) ), fc::assert_exception );
+}
+
+BOOST_AUTO_TEST_CASE(small_mutable_objects)
+{
+   fc::mutable_variant_object mvo;
+   mvo( "a", 1 )( "b", "two" );
+   mvo.emplace( "c", fc::variants{ fc::variant( 3 ) } ).emplace( fc::static_key( "d" ), 4.5 );
+   BOOST_CHECK_EQUAL( mvo.size(), 4u );
+   const char* first = reinterpret_cast<const char*>( &*mvo.begin() );
+   BOOST_CHECK( first >= reinterpret_cast<const char*>( &mvo ) && first < reinterpret_cast<const char*>( &mvo + 1 ) );
+   BOOST_CHECK_EQUAL( fc::json::to_string( mvo ), "{\"a\":1,\"b\":\"two\",\"c\":[3],\"d\":\"4.50000000000000000\"}" );
+
+   // growing past the inline entries and reserving keep lookups and order intact
+   mvo.reserve( 32 );
+   for( int i = 0; i < 20; ++i )
+      mvo.emplace( "k" + fc::to_string( int64_t(i) ), i );
+   mvo.emplace( "a", 2 ); // emplace does not replace, the first entry still wins
+   BOOST_CHECK_EQUAL( mvo["a"].as_int64(), 1 );
+   BOOST_CHECK_EQUAL( mvo["k19"].as_int64(), 19 );
+
+   fc::mutable_variant_object moved( std::move( mvo ) );
+   BOOST_CHECK_EQUAL( mvo.size(), 0u );
+   BOOST_CHECK_EQUAL( moved.size(), 25u );
+   fc::variant_object vo( std::move( moved ) );
+   BOOST_CHECK_EQUAL( vo.size(), 25u );
+   BOOST_CHECK_EQUAL( vo["k7"].as_int64(), 7 );
+   BOOST_CHECK_EQUAL( moved.size(), 0u );
+
+   // a chain on a temporary is moved into the variant_object it becomes
+   std::string key( "a key too long for the small string buffer" );
+   const char* key_data = key.data();
+   fc::variant_object args = fc::mutable_variant_object()( std::move( key ), 1 )( "x", 2 );
+   BOOST_CHECK( args.begin()->key().data() == key_data );
+   BOOST_CHECK_EQUAL( args["x"].as_int64(), 2 );
+}
+
+BOOST_AUTO_TEST_CASE(size_estimates_and_parse_limits)
+{
+   BOOST_CHECK_EQUAL( fc::estimated_size( fc::variant( 1 ) ), sizeof(fc::variant) );
+   BOOST_CHECK_EQUAL( fc::estimated_size( fc::variant( "inline" ) ), sizeof(fc::variant) );
+   const std::string long_str( "a string that is too long to be stored inline" );
+   BOOST_CHECK( fc::estimated_size( fc::variant( long_str ) ) > sizeof(fc::variant) + long_str.size() );
+
+   const std::string json = "{\"a\":[1,2,{\"b\":\"a string that is too long to be stored inline\"}],\"c\":[[]]}";
+   const fc::variant tree = fc::json::from_string( json );
+   const size_t size = fc::estimated_size( tree );
+   BOOST_CHECK( size > fc::estimated_size( tree["a"] ) + fc::estimated_size( tree["c"] ) );
+   // a variant holds its object or array in a payload
+   BOOST_CHECK_EQUAL( fc::estimated_size( tree.get_object() ) - sizeof(fc::variant_object),
+                      size - sizeof(fc::variant) - sizeof(fc::detail::variant_payload<fc::variant_object>) );
+   BOOST_CHECK_EQUAL( fc::estimated_size( tree["a"].get_array() ) - sizeof(fc::variants),
+                      fc::estimated_size( tree["a"] ) - sizeof(fc::variant) - sizeof(fc::detail::variant_payload<fc::variants>) );
+
+   // the json parser charges exactly the estimated size of the tree it builds
+   fc::parse_limits limits;
+   limits.max_bytes = size;
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::json::from_string( json, limits ) ), json );
+   limits.max_bytes = size - 1;
+   BOOST_CHECK_THROW( fc::json::from_string( json, limits ), fc::assert_exception );
+
+   limits = fc::parse_limits();
+   limits.max_nodes = 8; // the root, three arrays, two numbers, the nested object and its string
+   BOOST_CHECK_NO_THROW( fc::json::from_string( json, limits, fc::json::strict_parser ) );
+   limits.max_nodes = 7;
+   BOOST_CHECK_THROW( fc::json::from_string( json, limits, fc::json::strict_parser ), fc::assert_exception );
+
+   limits = fc::parse_limits();
+   limits.max_depth = 3;
+   BOOST_CHECK_NO_THROW( fc::json::from_string( json, limits ) );
+   limits.max_depth = 2;
+   BOOST_CHECK_THROW( fc::json::from_string( json, limits ), fc::assert_exception );
+   BOOST_CHECK( fc::parse_budget::current() == nullptr );
+
+   // a single string or container is rejected while it grows, these never end and would
+   // otherwise fail with a parse error once the whole text had been read into them
+   limits = fc::parse_limits();
+   limits.max_bytes = 64 * 1024;
+   std::string flat_array = "[";
+   std::string flat_object = "{";
+   for( uint32_t i = 0; i < 100000; ++i )
+   {
+      flat_array += "1,";
+      flat_object += "\"" + fc::to_string( uint64_t(i) ) + "\":1,";
+   }
+   for( const auto ptype : { fc::json::legacy_parser, fc::json::structural_parser } )
+   {
+      BOOST_CHECK_THROW( fc::json::from_string( "\"" + std::string( 1024 * 1024, 'x' ), limits, ptype ), fc::assert_exception );
+      BOOST_CHECK_THROW( fc::json::from_string( "[\"" + std::string( 1024 * 1024, 'x' ) + "\"", limits, ptype ), fc::assert_exception );
+      BOOST_CHECK_THROW( fc::json::from_string( flat_array, limits, ptype ), fc::assert_exception );
+      BOOST_CHECK_THROW( fc::json::from_string( flat_object, limits, ptype ), fc::assert_exception );
+      BOOST_CHECK_THROW( fc::json::from_string( flat_array, ptype ), fc::eof_exception );
+   }
+
+   // raw unpacking enforces the same limits
+   limits = fc::parse_limits();
+   limits.max_depth = 3;
+   const auto packed = fc::raw::pack( tree );
+   fc::variant unpacked;
+   fc::datastream<const char*> ds( packed.data(), packed.size() );
+   fc::raw::unpack( ds, unpacked, limits );
+   BOOST_CHECK_EQUAL( fc::json::to_string( unpacked ), json );
+   limits.max_depth = 2;
+   fc::datastream<const char*> shallow( packed.data(), packed.size() );
+   BOOST_CHECK_THROW( fc::raw::unpack( shallow, unpacked, limits ), fc::assert_exception );
+
+   // a huge array announced by a few bytes fails before its slots are allocated
+   std::vector<char> hostile = fc::raw::pack( fc::unsigned_int( 600000 ) );
+   hostile.insert( hostile.begin(), char(fc::variant::array_type) );
+   limits = fc::parse_limits();
+   limits.max_bytes = 1024 * 1024;
+   fc::datastream<const char*> huge( hostile.data(), hostile.size() );
+   BOOST_CHECK_THROW( fc::raw::unpack( huge, unpacked, limits ), fc::assert_exception );
+}
+
+BOOST_AUTO_TEST_SUITE_END()